@@ -5,40 +5,111 @@
 #include "add.h"
 
 
-//Adds a file to the staging area.
-void add (string file) {
+//Expands a path given to add into the files it names. Directories are walked recursively, and ignored
+//directories are pruned before they are descended into. Files named explicitly are always added.
+void collectFilesToAdd(const string& path, vector<string>& files, IgnoreMatcher& ignoreMatcher) {
+    if (!filesystem::is_directory(path)) {
+        files.push_back(filesystem::path(path).lexically_normal().generic_string());
+        return;
+    }
+
+    for (filesystem::recursive_directory_iterator it(path), end; it != end; ++it) {
+        string entryPath = it->path().lexically_normal().generic_string();
+        bool isDirectory = it->is_directory();
+
+        if (ignoreMatcher.isIgnored(entryPath, isDirectory)) {
+            if (isDirectory) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+
+        if (it->is_regular_file()) {
+            files.push_back(entryPath);
+        }
+    }
+}
+
+
+
+
+//Adds files to the staging area. Blobs are hashed and compressed on one thread per core,
+//and their object files are written through an ObjectWriter so the writes overlap.
+void add(vector<string> paths) {
     if (!filesystem::exists(".mygit/")) {
         cout << "Must initialize a mygit repository first using mygit init." << endl;
         exit(1);
     }
 
-    //Read the file and return it as a string.
-    string fileToAdd = readFile(file);
+    vector<string> files;
+    IgnoreMatcher ignoreMatcher;
+    WorkingTreeStatus changes;
 
-    int bytes = fileToAdd.size();
+    //With a running fsmonitor, adding the whole tree only has to read the files it reports as changed.
+    if (paths.size() == 1 && paths[0] == "." && scanWorkingTree(changes, false)) {
+        files = changes.modified;
+        files.insert(files.end(), changes.untracked.begin(), changes.untracked.end());
+    } else {
+        for (int i = 0; i < paths.size(); i++) {
+            collectFilesToAdd(paths[i], files, ignoreMatcher);
+        }
+    }
 
-    string blobString = "blob " + to_string(bytes) + '\0' + fileToAdd;
+    vector<string> hashes(files.size());
+    ObjectWriter writer;
 
-    string hashedBlobString = sha256(blobString);
+    size_t threadCount = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), files.size()));
+    atomic<size_t> next{0};
+    vector<thread> hashers;
 
-    string hashFolderName = hashedBlobString.substr(0,2);
-    string hashFileName = hashedBlobString.substr(2, hashedBlobString.length());
+    for (size_t t = 0; t < threadCount; t++) {
+        hashers.emplace_back([&] {
+            for (size_t i = next++; i < files.size(); i = next++) {
+                //Read the file and store it as a blob object.
+                hashes[i] = writeObject(writer, "blob", readFile(files[i]));
+            }
+        });
+    }
 
-    if (!filesystem::exists(".mygit/objects/" + hashFolderName + "/" + hashFileName)) {
-        filesystem::create_directory(".mygit/objects/" + hashFolderName);
-        ofstream hashFile (".mygit/objects/" + hashFolderName + "/" + hashFileName);
-        hashFile << blobString;
+    for (int i = 0; i < hashers.size(); i++) {
+        hashers[i].join();
     }
 
-    //Add file to the staging area for commit.
+    writer.flush();
+
+    if (writer.failures() > 0) {
+        cout << "Failed writing " << writer.failures() << " objects." << endl;
+        exit(1);
+    }
+
+    //Add files to the staging area for commit.
     ofstream indexFile(".mygit/index", ios::app);
     if (indexFile.is_open()) {
-        string indexContents = hashedBlobString + " " + file + "\n";
+        string indexContents;
+        for (int i = 0; i < files.size(); i++) {
+            indexContents += hashes[i] + " " + files[i] + "\n";
+        }
         indexFile << indexContents;
         indexFile.close();
-        cout << "added " << file << " to the staging area." << endl;
+
+        for (int i = 0; i < files.size(); i++) {
+            cout << "added " << files[i] << " to the staging area." << endl;
+        }
 
     } else {
         cout << "Error opening index file." << endl;
     }
-}
\ No newline at end of file
+}
+
+
+
+
+//Stages every tracked file that differs from the index or HEAD, for commit -a. Untracked files are left alone.
+void addTrackedChanges() {
+    WorkingTreeStatus changes;
+    scanWorkingTree(changes, true);
+
+    if (!changes.modified.empty()) {
+        add(changes.modified);
+    }
+}
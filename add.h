@@ -9,12 +9,20 @@
 #include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 #include "util.h"
+#include "objectWriter.h"
+#include "ignore.h"
+#include "status.h"
 
 using namespace std;
 
-void add(string);
+void collectFilesToAdd(const string&, vector<string>&, IgnoreMatcher&);
+void add(vector<string>);
+void addTrackedChanges();
 
 
 #endif //ADD_H
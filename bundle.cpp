@@ -0,0 +1,527 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "bundle.h"
+
+
+BundleWriter::BundleWriter(ostream& out) : out(out) {
+    context = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(context, EVP_sha256(), nullptr);
+}
+
+
+
+
+BundleWriter::~BundleWriter() {
+    EVP_MD_CTX_free(context);
+}
+
+
+
+
+void BundleWriter::write(const string& data) {
+    EVP_DigestUpdate(context, data.data(), data.size());
+    out.write(data.data(), data.size());
+}
+
+
+
+
+//Returns the binary SHA-256 of everything written so far.
+string BundleWriter::digest() {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    EVP_DigestFinal_ex(context, hash, nullptr);
+    return string(reinterpret_cast<char*>(hash), SHA256_DIGEST_LENGTH);
+}
+
+
+
+
+BundleReader::BundleReader(istream& in) : in(in) {
+    context = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(context, EVP_sha256(), nullptr);
+}
+
+
+
+
+BundleReader::~BundleReader() {
+    EVP_MD_CTX_free(context);
+}
+
+
+
+
+//Reads exactly size bytes into data. Returns false if the bundle ends first.
+bool BundleReader::read(string& data, size_t size) {
+    data.resize(size);
+    in.read(&data[0], size);
+
+    if ((size_t)in.gcount() != size) {
+        return false;
+    }
+
+    EVP_DigestUpdate(context, data.data(), size);
+    return true;
+}
+
+
+
+
+//Returns the binary SHA-256 of everything read so far.
+string BundleReader::digest() {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    EVP_DigestFinal_ex(context, hash, nullptr);
+    return string(reinterpret_cast<char*>(hash), SHA256_DIGEST_LENGTH);
+}
+
+
+
+
+//Lengths in the pack are 8 bytes, big-endian.
+string encodeLength(unsigned long long length) {
+    string encoded(8, '\0');
+    for (int i = 7; i >= 0; i--) {
+        encoded[i] = length & 0xff;
+        length >>= 8;
+    }
+    return encoded;
+}
+
+
+
+
+unsigned long long decodeLength(const string& encoded) {
+    unsigned long long length = 0;
+    for (int i = 0; i < 8; i++) {
+        length = length << 8 | (unsigned char)encoded[i];
+    }
+    return length;
+}
+
+
+
+
+//Writes one object to the pack as its binary hash, its length and its loose object file as stored.
+//The stored file is already compressed, so it is copied without inflating or deflating it again.
+void writePackedObject(BundleWriter& writer, const string& hash, unordered_set<string>& written) {
+    if (!written.insert(hash).second) {
+        return;
+    }
+
+    string data = readFile(objectPath(hash));
+    vector<unsigned char> hashBinary = hashStringToBinary(hash);
+
+    writer.write(string(hashBinary.begin(), hashBinary.end()) + encodeLength(data.size()));
+    writer.write(data);
+}
+
+
+
+
+//Writes a tree and everything below it, skipping subtrees that are already in the pack.
+void writePackedTree(BundleWriter& writer, const string& treeHash, unordered_set<string>& written) {
+    if (written.count(treeHash) > 0) {
+        return;
+    }
+
+    writePackedObject(writer, treeHash, written);
+
+    vector<TreeEntry> entries = readTree(treeHash);
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].mode == DIRECTORY_MODE) {
+            writePackedTree(writer, entries[i].hash, written);
+        } else {
+            writePackedObject(writer, entries[i].hash, written);
+        }
+    }
+}
+
+
+
+
+//Checks that a packed object inflates to a well-formed object whose hash is the one it was sent with.
+bool verifyPackedObject(const PackedObject& object) {
+    vector<unsigned char> compressed(object.data.begin(), object.data.end());
+    vector<unsigned char> inflated = decompressUsingInflate(compressed);
+    string content(inflated.begin(), inflated.end());
+
+    size_t space = content.find(' ');
+    size_t headerEnd = content.find('\0');
+    if (space == string::npos || headerEnd == string::npos || space > headerEnd) {
+        return false;
+    }
+
+    string type = content.substr(0, space);
+    if (type != "blob" && type != "tree" && type != "commit") {
+        return false;
+    }
+
+    if (content.substr(space + 1, headerEnd - space - 1) != to_string(content.size() - headerEnd - 1)) {
+        return false;
+    }
+
+    return sha256(content) == object.hash;
+}
+
+
+
+
+//Writes a bundle of the given branches (or HEAD) to file, or to stdout for "-". The header lists the refs and
+//any shallow commits, then every object reachable from the refs is streamed into the pack as it is found.
+//The pack ends with an empty entry and the SHA-256 of the whole bundle.
+void createBundle(const string& file, const vector<string>& refs) {
+    vector<pair<string, string>> tips;
+
+    for (int i = 0; i < refs.size(); i++) {
+        string refName = refs[i];
+        if (refName == "HEAD") {
+            ifstream headFile(".mygit/HEAD");
+            refName = parseHeadForBranch(headFile).substr(string("refs/heads/").size());
+        }
+
+        string hash = resolveRevision(refName);
+        if (hash.empty() || !filesystem::is_regular_file(".mygit/refs/heads/" + refName)) {
+            cerr << "Unknown branch: " << refs[i] << endl;
+            exit(1);
+        }
+
+        tips.push_back(make_pair(hash, "refs/heads/" + refName));
+    }
+
+    //Walk the commits first so the header can list the shallow ones.
+    vector<string> commits;
+    vector<string> stack;
+    unordered_set<string> seen;
+    string header = BUNDLE_SIGNATURE + "\n";
+
+    for (int i = 0; i < tips.size(); i++) {
+        stack.push_back(tips[i].first);
+    }
+
+    while (!stack.empty()) {
+        string hash = stack.back();
+        stack.pop_back();
+
+        CommitInfo commit;
+        if (!seen.insert(hash).second || !readCommit(hash, commit)) {
+            continue;
+        }
+
+        commits.push_back(hash);
+        stack.insert(stack.end(), commit.parents.begin(), commit.parents.end());
+
+        if (shallowCommits().count(hash) > 0) {
+            header += "shallow " + hash + "\n";
+        }
+    }
+
+    for (int i = 0; i < tips.size(); i++) {
+        header += tips[i].first + " " + tips[i].second + "\n";
+    }
+    header += "\n";
+
+    ofstream bundleFile;
+    if (file != "-") {
+        bundleFile.open(file, ios::binary | ios::trunc);
+        if (!bundleFile.is_open()) {
+            cerr << "Failed to create bundle " << file << endl;
+            exit(1);
+        }
+    }
+
+    ostream& out = file == "-" ? cout : bundleFile;
+    BundleWriter writer(out);
+    unordered_set<string> written;
+    Progress progress("Writing objects", 0);
+
+    writer.write(header + PACK_SIGNATURE);
+
+    for (int i = 0; i < commits.size(); i++) {
+        CommitInfo commit;
+        readCommit(commits[i], commit);
+
+        writePackedObject(writer, commits[i], written);
+        writePackedTree(writer, commit.tree, written);
+        progress.update(written.size());
+    }
+
+    writer.write(string(SHA256_DIGEST_LENGTH, '\0') + encodeLength(0));
+    out.write(writer.digest().data(), SHA256_DIGEST_LENGTH);
+    out.flush();
+    progress.finish();
+
+    if (!out) {
+        cerr << "Failed writing bundle" << endl;
+        exit(1);
+    }
+
+    cerr << "Bundled " << written.size() << " objects from " << commits.size() << " commits." << endl;
+}
+
+
+
+
+//Reads a bundle from file, or from stdin for "-", into the repository. Objects are read in one pass while a
+//pool of threads inflates and hash-checks them and hands them to an ObjectWriter. The refs are only updated
+//once every object and the bundle checksum have been verified, and then all of them are updated together.
+//With force, refs that are not fast-forwards are replaced as well.
+void unbundle(const string& file, bool force) {
+    ifstream bundleFile;
+    if (file != "-") {
+        bundleFile.open(file, ios::binary);
+        if (!bundleFile.is_open()) {
+            cout << "Failed to open bundle " << file << endl;
+            exit(1);
+        }
+    } else {
+        ios::sync_with_stdio(false);
+    }
+
+    istream& in = file == "-" ? cin : bundleFile;
+    BundleReader reader(in);
+
+    //Header lines up to the blank line.
+    vector<pair<string, string>> refs;
+    vector<string> shallow;
+    string line;
+    string byte;
+    bool firstLine = true;
+
+    while (true) {
+        line.clear();
+        while (reader.read(byte, 1) && byte[0] != '\n') {
+            line += byte;
+        }
+
+        if (firstLine && line != BUNDLE_SIGNATURE) {
+            cout << "Not a mygit bundle" << endl;
+            exit(1);
+        }
+
+        if (!firstLine && line.empty()) {
+            break;
+        }
+
+        if (!firstLine && line.rfind("shallow ", 0) == 0) {
+            shallow.push_back(line.substr(8));
+        } else if (!firstLine) {
+            size_t space = line.find(' ');
+            if (space != 2 * SHA256_DIGEST_LENGTH || line.compare(space + 1, 11, "refs/heads/") != 0 ||
+                line.find("..") != string::npos) {
+                cout << "Malformed bundle header: " << line << endl;
+                exit(1);
+            }
+            refs.push_back(make_pair(line.substr(0, space), line.substr(space + 1)));
+        }
+
+        firstLine = false;
+    }
+
+    string signature;
+    if (!reader.read(signature, PACK_SIGNATURE.size()) || signature != PACK_SIGNATURE) {
+        cout << "Bundle has no pack" << endl;
+        exit(1);
+    }
+
+    deque<PackedObject> pending;
+    mutex pendingMutex;
+    condition_variable workAvailable;
+    condition_variable spaceAvailable;
+    bool finished = false;
+    atomic<int> invalid{0};
+    atomic<size_t> verified{0};
+    ObjectWriter objectWriter;
+
+    vector<thread> verifiers;
+    size_t threadCount = max<size_t>(1, thread::hardware_concurrency());
+
+    for (size_t t = 0; t < threadCount; t++) {
+        verifiers.emplace_back([&] {
+            while (true) {
+                unique_lock<mutex> lock(pendingMutex);
+                workAvailable.wait(lock, [&] { return finished || !pending.empty(); });
+
+                if (pending.empty()) {
+                    return;
+                }
+
+                PackedObject object = move(pending.front());
+                pending.pop_front();
+                lock.unlock();
+                spaceAvailable.notify_one();
+
+                if (!verifyPackedObject(object)) {
+                    cout << "Corrupt object " << object.hash << " in bundle" << endl;
+                    invalid++;
+                    continue;
+                }
+
+                if (!filesystem::exists(objectPath(object.hash))) {
+                    objectWriter.submit(objectPath(object.hash), vector<unsigned char>(object.data.begin(), object.data.end()));
+                }
+                verified++;
+            }
+        });
+    }
+
+    Progress progress("Receiving objects", 0);
+    bool truncated = false;
+    string hashBinary;
+    string length;
+
+    while (true) {
+        PackedObject object;
+
+        if (!reader.read(hashBinary, SHA256_DIGEST_LENGTH) || !reader.read(length, 8)) {
+            truncated = true;
+            break;
+        }
+
+        unsigned long long size = decodeLength(length);
+        if (size == 0) {
+            break;
+        }
+
+        object.hash = hashBinaryToString(hashBinary);
+        if (!reader.read(object.data, size)) {
+            truncated = true;
+            break;
+        }
+
+        unique_lock<mutex> lock(pendingMutex);
+        spaceAvailable.wait(lock, [&] { return pending.size() < MAX_PENDING_VERIFICATIONS; });
+        pending.push_back(move(object));
+        lock.unlock();
+        workAvailable.notify_one();
+
+        progress.update(verified.load());
+    }
+
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        finished = true;
+    }
+    workAvailable.notify_all();
+
+    for (int i = 0; i < verifiers.size(); i++) {
+        verifiers[i].join();
+    }
+    objectWriter.flush();
+    progress.update(verified.load());
+    progress.finish();
+
+    string expectedDigest = reader.digest();
+    string trailer(SHA256_DIGEST_LENGTH, '\0');
+    in.read(&trailer[0], SHA256_DIGEST_LENGTH);
+
+    if (truncated || (size_t)in.gcount() != SHA256_DIGEST_LENGTH || trailer != expectedDigest) {
+        cout << "Bundle is truncated or its checksum does not match" << endl;
+        exit(1);
+    }
+
+    if (invalid > 0 || objectWriter.failures() > 0) {
+        cout << "Failed to store " << invalid + objectWriter.failures() << " objects; refs were not updated" << endl;
+        exit(1);
+    }
+
+    for (int i = 0; i < refs.size(); i++) {
+        if (!filesystem::exists(objectPath(refs[i].first))) {
+            cout << "Bundle does not contain " << refs[i].first << " for " << refs[i].second << endl;
+            exit(1);
+        }
+    }
+
+    //A shallow commit of the bundle only needs a marker here if its parents are still missing; otherwise the
+    //history below it is already present and a marker would hide it. The markers are known in memory before
+    //any history is walked, and only saved for commits an updated ref reaches.
+    unordered_set<string>& knownShallow = shallowCommits();
+    vector<string> newShallow;
+    for (int i = 0; i < shallow.size(); i++) {
+        CommitInfo info;
+        if (knownShallow.count(shallow[i]) > 0 || !readCommit(shallow[i], info)) {
+            continue;
+        }
+
+        for (int p = 0; p < info.parents.size(); p++) {
+            if (!filesystem::exists(objectPath(info.parents[p]))) {
+                knownShallow.insert(shallow[i]);
+                newShallow.push_back(shallow[i]);
+                break;
+            }
+        }
+    }
+
+    //A ref only moves forward, unless forced, and the checked-out branch is never moved, since the working
+    //tree and index would no longer match it. Those refs are reported and left for the user to merge.
+    ifstream headFile(".mygit/HEAD");
+    string headBranch = parseHeadForBranch(headFile);
+    CommitGraph graph;
+    int refused = 0;
+
+    for (int i = 0; i < refs.size(); i++) {
+        string current = readRef(".mygit/" + refs[i].second);
+        if (current == refs[i].first) {
+            cout << refs[i].second << " is already up to date" << endl;
+            refs.erase(refs.begin() + i--);
+            continue;
+        }
+
+        if (current.empty()) {
+            continue;
+        }
+
+        bool fastForward = mergeBase(current, refs[i].first, graph) == current;
+        if (refs[i].second == headBranch || (!fastForward && !force)) {
+            cout << refs[i].second << " not updated to " << refs[i].first
+                 << (refs[i].second == headBranch ? ": it is checked out" : ": not a fast-forward") << endl;
+            refs.erase(refs.begin() + i--);
+            refused++;
+        }
+    }
+
+    //Shallow markers go in before the refs that depend on them.
+    ofstream shallowFile(SHALLOW_PATH, ios::app);
+    for (int i = 0; i < newShallow.size(); i++) {
+        for (int r = 0; r < refs.size(); r++) {
+            if (mergeBase(newShallow[i], refs[r].first, graph) == newShallow[i]) {
+                shallowFile << newShallow[i] << "\n";
+                break;
+            }
+        }
+    }
+    shallowFile.close();
+
+    //Write every new ref to its lock file first, so a failure leaves all refs untouched, then move them all in.
+    vector<string> locks;
+    for (int i = 0; i < refs.size(); i++) {
+        string lockPath = ".mygit/" + refs[i].second + ".lock";
+        filesystem::create_directories(filesystem::path(lockPath).parent_path());
+
+        ofstream lockFile(lockPath, ios::trunc);
+        lockFile << refs[i].first;
+        lockFile.close();
+
+        if (!lockFile) {
+            for (int l = 0; l < locks.size(); l++) {
+                filesystem::remove(locks[l]);
+            }
+            cout << "Failed to write " << lockPath << "; refs were not updated" << endl;
+            exit(1);
+        }
+
+        locks.push_back(lockPath);
+    }
+
+    for (int i = 0; i < refs.size(); i++) {
+        filesystem::rename(locks[i], ".mygit/" + refs[i].second);
+        cout << refs[i].second << " -> " << refs[i].first << endl;
+    }
+
+    cout << "Unbundled " << verified.load() << " objects." << endl;
+
+    if (refused > 0) {
+        exit(1);
+    }
+}
@@ -0,0 +1,82 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+#include <openssl/evp.h>
+
+#include "util.h"
+#include "commit.h"
+#include "merge.h"
+#include "tree.h"
+#include "objectWriter.h"
+#include "progress.h"
+
+using namespace std;
+
+const string BUNDLE_SIGNATURE = "# mygit bundle v1";
+const string PACK_SIGNATURE = "MYPK";
+
+//Objects waiting to be verified during unbundle. Bounds memory when reading from a fast source.
+constexpr size_t MAX_PENDING_VERIFICATIONS = 1024;
+
+
+//Streams a bundle while keeping a running SHA-256 of everything written, for the trailer.
+class BundleWriter {
+public:
+    explicit BundleWriter(ostream&);
+    ~BundleWriter();
+
+    void write(const string&);
+    string digest();
+
+private:
+    ostream& out;
+    EVP_MD_CTX* context;
+};
+
+
+//Reads a bundle while keeping a running SHA-256 of everything read, to check the trailer.
+class BundleReader {
+public:
+    explicit BundleReader(istream&);
+    ~BundleReader();
+
+    bool read(string&, size_t);
+    string digest();
+
+private:
+    istream& in;
+    EVP_MD_CTX* context;
+};
+
+
+struct PackedObject {
+    string hash;
+    string data;
+};
+
+
+
+string encodeLength(unsigned long long);
+unsigned long long decodeLength(const string&);
+void writePackedObject(BundleWriter&, const string&, unordered_set<string>&);
+void writePackedTree(BundleWriter&, const string&, unordered_set<string>&);
+bool verifyPackedObject(const PackedObject&);
+void createBundle(const string&, const vector<string>&);
+void unbundle(const string&, bool);
+
+
+#endif //BUNDLE_H
@@ -5,123 +5,109 @@
 #include "commit.h"
 
 
-//Logs all previous commits.
-void commitLog() {
-    ifstream headFile(".mygit/HEAD");
-    ifstream branchFile(".mygit/" + parseHeadForBranch(headFile));
-
-
-    string commitHash;
-    string commitObject;
-    string parentHash;
-    bool parentFound;
-
-
-    //Get latest commit object file
-    if (branchFile.is_open()) {
-        getline(branchFile, commitHash);
-        commitObject = commitHash.substr(0,2) + "/" + commitHash.substr(2, commitHash.length());
-
-        branchFile.close();
-    } else {
-        cout << "Branch file failed to open" << endl;
-    }
-
-
-        do {
-            ifstream commitObjectFile(".mygit/objects/" + commitObject, ios::binary);
-
-            if (!commitObjectFile.is_open()) {
-                cout << "Failed to open commit object file" << endl;
-                break;
+//Parses the raw content of a commit object. Header lines run up to the first blank line; older commits
+//have no blank line, so the message starts at the first line that is not a known header.
+CommitInfo parseCommit(const string& hash, const string& content) {
+    CommitInfo info;
+    info.hash = hash;
+
+    istringstream stream(content);
+    string line;
+    size_t consumed = 0;
+
+    while (getline(stream, line)) {
+        size_t space = line.find(' ');
+        string key = line.substr(0, space);
+        string value = space == string::npos ? "" : line.substr(space + 1);
+
+        if (key == "tree") {
+            info.tree = value;
+        } else if (key == "parent") {
+            info.parents.push_back(value);
+        } else if (key == "author" || key == "committer") {
+            //Identity is "name <email>", optionally followed by "<unix time> <timezone>".
+            size_t emailEnd = value.find('>');
+            string identity = value.substr(0, emailEnd == string::npos ? value.size() : emailEnd + 1);
+            long long time = 0;
+
+            if (emailEnd != string::npos && emailEnd + 2 < value.size()) {
+                time = atoll(value.c_str() + emailEnd + 2);
             }
 
-            cout << "Opening: " << ".mygit/objects/" + commitObject << endl;
+            if (key == "author") {
+                info.author = identity;
+                info.authorTime = time;
+            } else {
+                info.committer = identity;
+                info.commitTime = time;
+            }
+        } else {
+            if (!line.empty()) {
+                info.message = content.substr(consumed);
+            } else if (consumed + 1 < content.size()) {
+                info.message = content.substr(consumed + 1);
+            }
+            break;
+        }
 
-            //Convert commit object file
-            vector<char> dataSigned{istreambuf_iterator<char>(commitObjectFile), istreambuf_iterator<char>()};
+        consumed += line.size() + 1;
+    }
 
-            commitObjectFile.close();
+    return info;
+}
 
-            vector<unsigned char> data(dataSigned.begin(), dataSigned.end());
 
-            //Decompress commit object file
-            vector<unsigned char> decompressedData = decompressUsingInflate(data);
 
 
-            //String holds all of commit file contents
-            string commitObjectContents(decompressedData.begin(), decompressedData.end());
+//Reads a commit object by hash. Returns false if it is missing or not a commit.
+//A commit marked shallow is returned without parents.
+bool readCommit(const string& hash, CommitInfo& info) {
+    string type;
+    string content;
 
-            cout << commitObjectContents << "\n\n";
+    if (!readObject(hash, type, content) || type != "commit") {
+        return false;
+    }
 
+    info = parseCommit(hash, content);
 
-            //Extract the parent hash from the string
-            if (commitObjectContents.find("parent ") != string::npos) {
-                parentFound = true;
-                int hashStart = commitObjectContents.find("parent ") + 7;
-                int hashLength = 64;
+    if (shallowCommits().count(hash) > 0) {
+        info.parents.clear();
+    }
 
+    return true;
+}
 
-                parentHash = commitObjectContents.substr(hashStart,
-                    2) + "/" + commitObjectContents.substr(hashStart + 2, hashLength - 2);
 
-                //Make the parent hash the new current commit object
-                commitObject = parentHash;
-            } else {
-                parentFound = false;
-            }
-        } while (parentFound);
 
-}
 
-//Builds the commit tree from all of the entries in the index file and returns the hash of the tree.
-string buildCommitTree(vector<IndexEntry>& indexEntries) {
-    vector<unsigned char> tree;
-    //Construct the tree for all entries in the index.
+//Builds the commit tree from the entries in the index file on top of the tree of the previous commit
+//and returns the hash of the tree. Entries added later in the index override earlier ones.
+//Trees are written bottom-up and recorded in the journal, skipping any an interrupted run already wrote.
+string buildCommitTree(const string& baseTree, vector<IndexEntry>& indexEntries, TreeJournal& journal) {
+    map<string, string> changes;
     for (int i = 0; i < indexEntries.size(); i++) {
-        tree.insert(tree.end(), NORMAL_FILE_MODE.begin(), NORMAL_FILE_MODE.end());
-        tree.push_back(' ');
-        tree.insert(tree.end(), indexEntries[i].path.begin(), indexEntries[i].path.end());
-        tree.push_back('\0');
-        tree.insert(tree.end(), indexEntries[i].hashBinary.begin(), indexEntries[i].hashBinary.end());
+        changes[indexEntries[i].path] = indexEntries[i].hashString;
     }
 
-    string treeContent;
-    int treeLength = tree.size();
-
-    treeContent = "tree " + to_string(treeLength) + '\0';
-    treeContent.insert(treeContent.end(), tree.begin(), tree.end());
+    Progress progress("Writing trees", countTreesToWrite(changes));
+    journal.setProgress(&progress);
 
-    //Convert treeContent string to vector<unsigned char>
-    vector<unsigned char> treeContentVec(treeContent.begin(), treeContent.end());
+    //Hash, compress and write the changed trees.
+    ObjectWriter writer;
+    string hashedTree = writeTreeWithChanges(baseTree, changes, writer, &journal);
+    journal.sync(writer);
+    writer.flush();
 
-    //Hashed tree to use for the file name in objects.
-    string hashedTree = sha256(treeContent);
+    journal.setProgress(nullptr);
+    progress.finish();
 
-    //Split hash for proper file structure (as used in git)
-    string hashedTreeDir = ".mygit/objects/" + hashedTree.substr(0, 2);
-
-    //Create the directory for the hashed tree.
-    if (!filesystem::exists(hashedTreeDir)) {
-        filesystem::create_directory(hashedTreeDir);
-    } else {
-        cout << "Tree directory already exists." << endl;
+    if (writer.failures() > 0) {
+        cout << "Failed writing " << writer.failures() << " tree objects. Run commit again to resume." << endl;
+        exit(1);
     }
 
-    string hashedTreeFilePath = hashedTreeDir + "/" + hashedTree.substr(3, hashedTree.size());
-
-    if (!filesystem::exists(".mygit/objects/" + hashedTree)) {
-        //Compress the tree
-        vector<unsigned char> compressedTree = compressUsingDeflate(treeContentVec);
-
-        //Write compressedTree to file
-        writeBinaryToFile(hashedTreeFilePath, compressedTree);
-
-        cout << "created tree object file at " << hashedTreeFilePath << endl;
-
-    } else {
-        cout << "tree already exists in objects." << endl;
-    }
+    cout << "created tree object file at " << objectPath(hashedTree) << endl;
 
     return hashedTree;
 }
@@ -129,10 +115,9 @@ string buildCommitTree(vector<IndexEntry>& indexEntries) {
 
 
 
-//Builds the commit object given a commit tree is made and a message is provided.
-void buildCommitObject(string hashedTree, string& message) {
-
-    string mainBranchFile = ".mygit/refs/heads/main";
+//Builds the commit object given a commit tree is made and a message is provided, points the current
+//branch at it and returns its hash. A merge commit has more than one parent.
+string buildCommitObject(const string& hashedTree, const vector<string>& parents, string& message) {
     string commitData;
 
     //Build commit object. <user, email>
@@ -141,94 +126,127 @@ void buildCommitObject(string hashedTree, string& message) {
     //Get user info from config file
     userInfo = parseConfigFileForUser();
 
-    //Before comitting current object, check if there is a previous commit. If there isn't, commit object has
-    //no parent hash.
-    if (!filesystem::is_empty(mainBranchFile)) {
-
-        //Read the previous commit hash
-        ifstream file(mainBranchFile);
+    //Identity lines carry the commit time so log can order and filter by date.
+    long long commitTime = time(nullptr);
+    string identity = userInfo.first + " <" + userInfo.second + "> " + to_string(commitTime) + " +0000";
 
-        if (file.is_open()) {
-            string previousCommitHash;
-            //Branch file will only have one hash, which is the previous commit objects hash.
-            getline(file, previousCommitHash);
-
-            file.close();
-
-            commitData = "tree " + hashedTree + "\n" + "parent " + previousCommitHash + "\n" +"author "
-            + userInfo.first + " <" + userInfo.second + ">" + "\n" + "committer "
-            + userInfo.first +" <" + userInfo.second + ">" + "\n" + message;
-        } else {
-            cout << "Unable to open main branch file" << endl;
-        }
-
-
-    } else {
-        commitData = "tree " + hashedTree + "\n" + "author " + userInfo.first + " <" + userInfo.second + ">" + "\n" +
-            "committer " + userInfo.first + " <" + userInfo.second + ">" + "\n" + message;
+    //The first commit has no parent hash.
+    commitData = "tree " + hashedTree + "\n";
+    for (int i = 0; i < parents.size(); i++) {
+        commitData += "parent " + parents[i] + "\n";
     }
+    commitData += "author " + identity + "\n" + "committer " + identity + "\n\n" + message;
 
     cout << "\ncomitting data: \n" << commitData;
 
-    int commitSize = commitData.size();
-    string commitObject = "commit " + to_string(commitSize) + '\0' + commitData;
-    string commitObjectHash = sha256(commitObject);
-    cout << "Creating a new commit object with hash: " << commitObjectHash << endl;
-
-    //create directory for commitFile.
-    filesystem::create_directory(".mygit/objects/" + commitObjectHash.substr(0,2));
+    //Hash, compress and write the commit object. It must be on disk before the branch points at it.
+    ObjectWriter writer(1);
+    string commitObjectHash = writeObject(writer, "commit", commitData);
+    writer.flush();
 
-    string commitFileDir = ".mygit/objects/" + commitObjectHash.substr(0, 2) + "/" +
-        commitObjectHash.substr(2, commitObjectHash.length());
-
-    //Convert the commitObject into a vector of characters for compression.
-    vector<unsigned char> commitObjectVec(commitObject.begin(), commitObject.end());
-
-    vector<unsigned char> compressedObjectFile = compressUsingDeflate(commitObjectVec);
+    if (writer.failures() > 0) {
+        cout << "Failed writing commit object" << endl;
+        exit(1);
+    }
 
-    //Write the compressed commit object to its file
-    writeBinaryToFile(commitFileDir, compressedObjectFile);
+    cout << "Creating a new commit object with hash: " << commitObjectHash << endl;
 
-    //Update HEAD
+    //Update HEAD. Write commit hash to branch file inside heads.
     ifstream headFile(".mygit/HEAD");
     string branchLocation = parseHeadForBranch(headFile);
 
-    //Write commit hash to branch file inside heads.
-    ofstream branchFileLocation(".mygit/" + branchLocation);
-
-    if (branchFileLocation.is_open()) {
-        branchFileLocation << commitObjectHash;
-    } else {
-        cout << "Failed to open branch heads file" << endl;
+    if (!updateRef(".mygit/" + branchLocation, commitObjectHash)) {
+        cout << "Failed to update branch heads file" << endl;
+        exit(1);
     }
 
-    branchFileLocation.close();
+    //Record the commit and its generation number for history walks.
+    CommitGraph graph;
+    graph.add(commitObjectHash, parents, commitTime);
+    graph.save();
+
+    return commitObjectHash;
 }
 
 
 
 
-//Handles commits. Retrieves all data from the index file, places it into a vector of structs,
-//converts hex string hashes to their binary interpretation, constructs the tree using that
-//binary interpretation, hashes that file for its filename, and writes its contents to that file.
+//Handles commits. Retrieves all data from the index file, builds the tree of the new commit on top of
+//the previous commit's tree, and writes the commit object. While a merge is in progress the merged tree
+//is used instead and the merged branch becomes a second parent.
+//Blobs are already in the object store, so a commit is trees, then the commit object, then the branch ref.
+//Written trees are journaled so a commit that is interrupted resumes where it stopped, and the index is only
+//cleared once the branch points at the new commit.
 void commit(string& message) {
 
     //Store all hashes and their corresponding files in a vector of entries.
-    vector<IndexEntry> indexEntries = collectAllIndexEntries();
+    string indexContents = readFile(".mygit/index");
+    istringstream indexStream(indexContents);
+    vector<IndexEntry> indexEntries = parseIndexEntries(indexStream);
+
+    vector<string> parents;
+    string baseTree;
+
+    string headCommit = resolveRevision("HEAD");
+    if (!headCommit.empty()) {
+        CommitInfo head;
+        if (!readCommit(headCommit, head)) {
+            cout << "Failed to read commit object " << headCommit << endl;
+            exit(1);
+        }
 
-    //Convert hash strings to their binary representation and store it.
-    for (int i = 0; i < indexEntries.size(); i++) {
-        indexEntries[i].hashBinary = hashStringToBinary(indexEntries[i].hashString);
+        parents.push_back(headCommit);
+        baseTree = head.tree;
+    }
+
+    bool merging = filesystem::exists(MERGE_HEAD_PATH);
+    if (merging) {
+        parents.push_back(readRef(MERGE_HEAD_PATH));
+        baseTree = readRef(MERGE_TREE_PATH);
+
+        //The merged tree holds conflict markers for these paths until they are resolved and added again.
+        set<string> staged;
+        for (int i = 0; i < indexEntries.size(); i++) {
+            staged.insert(indexEntries[i].path);
+        }
+
+        ifstream conflictsFile(MERGE_CONFLICTS_PATH);
+        string path;
+        bool unresolved = false;
+        while (getline(conflictsFile, path)) {
+            if (!path.empty() && staged.count(path) == 0) {
+                cout << "Unresolved conflict: " << path << endl;
+                unresolved = true;
+            }
+        }
+
+        if (unresolved) {
+            cout << "Fix the conflicts and add the files before committing the merge." << endl;
+            exit(1);
+        }
+    }
+
+    TreeJournal journal(COMMIT_JOURNAL_PATH, sha256(indexContents), baseTree);
+    if (journal.resumedCount() > 0) {
+        cout << "Resuming interrupted commit, " << journal.resumedCount() << " trees already written." << endl;
     }
 
     //Call buildCommitTree to build the tree, and get the hash of that tree.
-    string hashedTree = buildCommitTree(indexEntries);
+    string hashedTree = buildCommitTree(baseTree, indexEntries, journal);
 
     //Call buildCommitObject to build the commit object using the commit message and tree hash.
-    buildCommitObject(hashedTree, message);
+    buildCommitObject(hashedTree, parents, message);
+
+    if (merging) {
+        filesystem::remove(MERGE_HEAD_PATH);
+        filesystem::remove(MERGE_TREE_PATH);
+        filesystem::remove(MERGE_CONFLICTS_PATH);
+    }
 
     //Clear the staging area.
     ofstream indexFile(".mygit/index");
     indexFile.clear();
     indexFile.close();
-}
\ No newline at end of file
+
+    journal.remove();
+}
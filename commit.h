@@ -11,17 +11,40 @@
 #include <vector>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <ctime>
+#include <map>
+#include <set>
 
 #include "util.h"
+#include "objectWriter.h"
+#include "tree.h"
+#include "commitGraph.h"
+#include "progress.h"
 
 using namespace std;
 
-const string NORMAL_FILE_MODE = "100644";
-
-string buildCommitTree(vector<IndexEntry>&);
-void buildCommitObject(string, string&);
+const string MERGE_HEAD_PATH = ".mygit/MERGE_HEAD";
+const string MERGE_TREE_PATH = ".mygit/MERGE_TREE";
+const string MERGE_CONFLICTS_PATH = ".mygit/MERGE_CONFLICTS";
+const string COMMIT_JOURNAL_PATH = ".mygit/COMMIT_JOURNAL";
+
+struct CommitInfo {
+    string hash;
+    string tree;
+    vector<string> parents;
+    string author;
+    string committer;
+    long long authorTime = 0;
+    long long commitTime = 0;
+    string message;
+};
+
+string buildCommitTree(const string&, vector<IndexEntry>&, TreeJournal&);
+string buildCommitObject(const string&, const vector<string>&, string&);
 void commit(string&);
-void commitLog();
+CommitInfo parseCommit(const string&, const string&);
+bool readCommit(const string&, CommitInfo&);
 
 
 #endif //COMMIT_H
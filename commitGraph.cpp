@@ -0,0 +1,164 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "commitGraph.h"
+
+
+//Loads every commit recorded in the commit-graph file. Each line is "<hash> <generation> <time> <parents...>".
+CommitGraph::CommitGraph() {
+    ifstream graphFile(COMMIT_GRAPH_PATH);
+    string line;
+
+    if (!graphFile.is_open()) {
+        return;
+    }
+
+    while (getline(graphFile, line)) {
+        istringstream iss(line);
+        GraphNode graphNode;
+        string parent;
+
+        if (!(iss >> graphNode.hash >> graphNode.generation >> graphNode.commitTime)) {
+            continue;
+        }
+
+        //History below a shallow commit is absent, so its parents are not followed.
+        while (iss >> parent && shallowCommits().count(graphNode.hash) == 0) {
+            graphNode.parents.push_back(parent);
+        }
+
+        nodes[graphNode.hash] = graphNode;
+    }
+
+    graphFile.close();
+}
+
+
+
+
+//Checks whether a commit is already in the graph, without reading it.
+bool CommitGraph::contains(const string& hash) const {
+    return nodes.find(hash) != nodes.end();
+}
+
+
+
+
+//Returns the graph node of a commit, reading it (and any of its ancestors missing from the graph) if needed.
+//Returns nullptr if the commit does not exist.
+const GraphNode* CommitGraph::node(const string& hash) {
+    auto found = nodes.find(hash);
+    if (found != nodes.end()) {
+        return &found->second;
+    }
+
+    return load(hash);
+}
+
+
+
+
+//Records a commit whose parents are already known, such as one that was just written.
+void CommitGraph::add(const string& hash, const vector<string>& parents, long long commitTime) {
+    GraphNode graphNode;
+    graphNode.hash = hash;
+    graphNode.parents = parents;
+    graphNode.commitTime = commitTime;
+    graphNode.generation = 1;
+
+    for (int i = 0; i < parents.size(); i++) {
+        const GraphNode* parent = node(parents[i]);
+        if (parent != nullptr) {
+            graphNode.generation = max(graphNode.generation, parent->generation + 1);
+        }
+    }
+
+    nodes[hash] = graphNode;
+    unsaved.push_back(hash);
+}
+
+
+
+
+//Appends the commits added since the graph was loaded to the commit-graph file.
+void CommitGraph::save() {
+    if (unsaved.empty()) {
+        return;
+    }
+
+    filesystem::create_directories(filesystem::path(COMMIT_GRAPH_PATH).parent_path());
+    ofstream graphFile(COMMIT_GRAPH_PATH, ios::app);
+    if (!graphFile.is_open()) {
+        cout << "Failed to open commit-graph file" << endl;
+        return;
+    }
+
+    string lines;
+    for (int i = 0; i < unsaved.size(); i++) {
+        const GraphNode& graphNode = nodes[unsaved[i]];
+        lines += graphNode.hash + " " + to_string(graphNode.generation) + " " + to_string(graphNode.commitTime);
+
+        for (int p = 0; p < graphNode.parents.size(); p++) {
+            lines += " " + graphNode.parents[p];
+        }
+        lines += "\n";
+    }
+
+    graphFile << lines;
+    graphFile.close();
+    unsaved.clear();
+}
+
+
+
+
+//Reads a commit missing from the graph. Ancestors are resolved with an explicit stack rather than recursion
+//so a long history that predates the graph cannot overflow the call stack.
+const GraphNode* CommitGraph::load(const string& hash) {
+    unordered_map<string, CommitInfo> pending;
+    unordered_set<string> missing;
+    vector<string> stack;
+    stack.push_back(hash);
+
+    while (!stack.empty()) {
+        string current = stack.back();
+
+        if (nodes.find(current) != nodes.end()) {
+            stack.pop_back();
+            continue;
+        }
+
+        auto info = pending.find(current);
+        if (info == pending.end()) {
+            CommitInfo commit;
+            if (!readCommit(current, commit)) {
+                //A missing ancestor is treated as the end of history.
+                missing.insert(current);
+                stack.pop_back();
+                if (current == hash) {
+                    return nullptr;
+                }
+                continue;
+            }
+            info = pending.emplace(current, commit).first;
+        }
+
+        bool parentsReady = true;
+        for (int i = 0; i < info->second.parents.size(); i++) {
+            const string& parent = info->second.parents[i];
+            if (nodes.find(parent) == nodes.end() && missing.find(parent) == missing.end()) {
+                stack.push_back(parent);
+                parentsReady = false;
+            }
+        }
+
+        if (parentsReady) {
+            add(current, info->second.parents, info->second.commitTime);
+            pending.erase(info);
+            stack.pop_back();
+        }
+    }
+
+    return &nodes[hash];
+}
@@ -0,0 +1,52 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef COMMITGRAPH_H
+#define COMMITGRAPH_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "util.h"
+#include "commit.h"
+
+using namespace std;
+
+const string COMMIT_GRAPH_PATH = ".mygit/info/commit-graph";
+
+struct GraphNode {
+    string hash;
+    int generation = 0;
+    long long commitTime = 0;
+    vector<string> parents;
+};
+
+
+//Parents, commit times and generation numbers of commits, kept in .mygit/info/commit-graph so history walks
+//do not have to read and inflate every commit object. A commit's generation is one more than the largest
+//generation of its parents (roots are 1), so a commit can never be an ancestor of one with a lower generation.
+//Commits missing from the file are read once, then appended to it by save().
+class CommitGraph {
+public:
+    CommitGraph();
+
+    bool contains(const string&) const;
+    const GraphNode* node(const string&);
+    void add(const string&, const vector<string>&, long long);
+    void save();
+
+private:
+    const GraphNode* load(const string&);
+
+    unordered_map<string, GraphNode> nodes;
+    vector<string> unsaved;
+};
+
+
+#endif //COMMITGRAPH_H
@@ -0,0 +1,419 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "fsmonitor.h"
+
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+
+
+
+string changeLogPath(const string& session) {
+    return FSMONITOR_DIRECTORY + "changes-" + session;
+}
+
+
+
+
+//Reads the pid and current session of the daemon. Returns false if no daemon has registered.
+bool readDaemonFile(int& pid, string& session) {
+    ifstream daemonFile(FSMONITOR_DAEMON_PATH);
+    return daemonFile.is_open() && (daemonFile >> pid >> session) && pid > 0;
+}
+
+
+
+
+bool fsmonitorRunning() {
+    int pid;
+    string session;
+    return readDaemonFile(pid, session) && kill(pid, 0) == 0;
+}
+
+
+
+
+//Opens a new session: a fresh inotify instance, a watch on every directory that is not ignored, and an
+//empty change log. The daemon file is only rewritten once every watch is in place, so a token is never
+//handed out for a session that could still miss events.
+bool FsMonitorDaemon::startSession() {
+    session = to_string(time(nullptr)) + "-" + to_string(getpid()) + "-" + to_string(++sessionCount);
+    ignoreMatcher = make_unique<IgnoreMatcher>();
+    watchedDirectories.clear();
+    restart = false;
+
+    inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        return false;
+    }
+
+    changeLog = fopen(changeLogPath(session).c_str(), "w");
+    logBytes = 0;
+    if (changeLog == nullptr) {
+        return false;
+    }
+
+    //Cookies created by readers mark how far the log has caught up, and a new exclude file changes which
+    //directories should be watched.
+    cookieWatch = inotify_add_watch(inotifyFd, FSMONITOR_DIRECTORY.c_str(), IN_CREATE);
+    infoWatch = inotify_add_watch(inotifyFd, ".mygit/info", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+
+    if (cookieWatch < 0 || !watchDirectory("")) {
+        return false;
+    }
+
+    string temporaryPath = FSMONITOR_DAEMON_PATH + ".tmp";
+    ofstream daemonFile(temporaryPath, ios::trunc);
+    daemonFile << getpid() << " " << session << "\n";
+    daemonFile.close();
+
+    error_code ec;
+    filesystem::rename(temporaryPath, FSMONITOR_DAEMON_PATH, ec);
+    return !ec;
+}
+
+
+
+
+void FsMonitorDaemon::endSession() {
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+
+    if (changeLog != nullptr) {
+        fclose(changeLog);
+        changeLog = nullptr;
+    }
+
+    error_code ec;
+    filesystem::remove(changeLogPath(session), ec);
+}
+
+
+
+
+//Adds a watch on a directory and every directory below it that is not ignored. Returns false only when
+//the kernel refuses more watches, since the working tree can then no longer be monitored completely.
+bool FsMonitorDaemon::watchDirectory(const string& directory) {
+    string path = directory.empty() ? "." : directory;
+
+    int watch = inotify_add_watch(inotifyFd, path.c_str(), WATCH_MASK);
+    if (watch < 0) {
+        return errno != ENOSPC && errno != ENOMEM;
+    }
+    watchedDirectories[watch] = directory;
+
+    error_code ec;
+    for (filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_directory(ec) || it->is_symlink(ec)) {
+            continue;
+        }
+
+        string name = it->path().filename().string();
+        string childPath = directory.empty() ? name : directory + "/" + name;
+
+        if (!ignoreMatcher->isIgnored(childPath, true) && !watchDirectory(childPath)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+void FsMonitorDaemon::logPath(const string& path) {
+    string line = path + "\n";
+    fwrite(line.data(), 1, line.size(), changeLog);
+    logBytes += line.size();
+}
+
+
+
+
+void FsMonitorDaemon::handleEvents(const char* buffer, ssize_t length) {
+    for (const char* next = buffer; next < buffer + length; ) {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>(next);
+        next += sizeof(inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            restart = true;
+            continue;
+        }
+
+        string name = event->len > 0 ? string(event->name) : "";
+
+        if (event->wd == infoWatch) {
+            restart = restart || name == filesystem::path(EXCLUDE_FILE_PATH).filename().string();
+            continue;
+        }
+
+        if (event->wd == cookieWatch) {
+            if (name.compare(0, FSMONITOR_COOKIE_PREFIX.size(), FSMONITOR_COOKIE_PREFIX) == 0) {
+                logPath(FSMONITOR_DIRECTORY + name);
+            }
+            continue;
+        }
+
+        auto directory = watchedDirectories.find(event->wd);
+        if (directory == watchedDirectories.end()) {
+            continue;
+        }
+
+        if (event->mask & IN_IGNORED) {
+            watchedDirectories.erase(directory);
+            continue;
+        }
+
+        //Events about a watched directory itself are also reported, by name, to the directory above it.
+        if (name.empty() || (directory->second.empty() && name == ".mygit")) {
+            continue;
+        }
+
+        string path = directory->second.empty() ? name : directory->second + "/" + name;
+        logPath(path);
+
+        if (name == IGNORE_FILE_NAME) {
+            restart = true;
+        }
+
+        //Files created in a new directory before its watch exists are found when the reader expands the
+        //directory, so only the directory itself needs to be logged here.
+        if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+            !ignoreMatcher->isIgnored(path, true) && !watchDirectory(path)) {
+            restart = true;
+        }
+    }
+}
+
+
+
+
+//Runs until stopped, the repository disappears, or another daemon takes over. Each session ends when its
+//log grows too large, the event queue overflows, or the ignore rules change, and a new one starts.
+void FsMonitorDaemon::run() {
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+    signal(SIGHUP, SIG_IGN);
+
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (!stopRequested) {
+        if (!startSession()) {
+            endSession();
+            break;
+        }
+
+        while (!stopRequested && !restart) {
+            pollfd descriptor = {inotifyFd, POLLIN, 0};
+            int ready = poll(&descriptor, 1, FSMONITOR_POLL_MILLISECONDS);
+
+            //While the tree is quiet, check that the repository and this daemon's registration still exist.
+            if (ready == 0) {
+                int pid;
+                string current;
+                if (!readDaemonFile(pid, current) || pid != getpid()) {
+                    stopRequested = 1;
+                }
+                continue;
+            }
+
+            if (ready < 0) {
+                continue;
+            }
+
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                continue;
+            }
+
+            handleEvents(buffer, length);
+            fflush(changeLog);
+
+            if (logBytes > FSMONITOR_MAX_LOG_BYTES) {
+                restart = true;
+            }
+        }
+
+        endSession();
+    }
+
+    int pid;
+    string current;
+    if (readDaemonFile(pid, current) && pid == getpid()) {
+        error_code ec;
+        filesystem::remove(FSMONITOR_DAEMON_PATH, ec);
+    }
+}
+
+
+
+
+//Collects the paths changed since token and sets newToken to the current position. A cookie file is
+//created and waited for first, so every change made before the call is in the log. Returns false if
+//token is empty, from an older session, or the daemon is not answering; newToken is still set when
+//the daemon is running, so the caller can scan everything and continue from there.
+bool fsmonitorQuery(const string& token, string& newToken, vector<string>& changed) {
+    newToken = "";
+    changed.clear();
+
+    int pid;
+    string session;
+    if (!readDaemonFile(pid, session) || kill(pid, 0) != 0) {
+        return false;
+    }
+
+    string logPath = changeLogPath(session);
+    error_code ec;
+    size_t logSize = filesystem::file_size(logPath, ec);
+    if (ec) {
+        return false;
+    }
+
+    istringstream tokenStream(token);
+    string tokenSession;
+    size_t offset = 0;
+    bool valid = (tokenStream >> tokenSession >> offset) && tokenSession == session && offset <= logSize;
+    size_t start = valid ? offset : logSize;
+
+    string cookieName = FSMONITOR_COOKIE_PREFIX + to_string(getpid()) + "-" +
+                        to_string(chrono::steady_clock::now().time_since_epoch().count());
+    string cookiePath = FSMONITOR_DIRECTORY + cookieName;
+    string cookieLine = cookiePath + "\n";
+    ofstream(cookiePath).close();
+
+    //Wait for the daemon to log the cookie.
+    string contents;
+    size_t cookie = string::npos;
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(FSMONITOR_COOKIE_TIMEOUT_MILLISECONDS);
+
+    while (cookie == string::npos && chrono::steady_clock::now() < deadline) {
+        ifstream log(logPath, ios::binary);
+        log.seekg(start);
+        contents.assign(istreambuf_iterator<char>(log), istreambuf_iterator<char>());
+
+        cookie = contents.find(cookieLine);
+        if (cookie == string::npos) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+
+    filesystem::remove(cookiePath, ec);
+
+    if (cookie == string::npos) {
+        return false;
+    }
+
+    newToken = session + " " + to_string(start + cookie + cookieLine.size());
+
+    if (!valid) {
+        return false;
+    }
+
+    istringstream lines(contents.substr(0, cookie));
+    string line;
+    while (getline(lines, line)) {
+        //Cookies from other readers are not working tree paths.
+        if (!line.empty() && line.compare(0, FSMONITOR_DIRECTORY.size(), FSMONITOR_DIRECTORY) != 0) {
+            changed.push_back(line);
+        }
+    }
+
+    return true;
+}
+
+
+
+
+//Starts the daemon in the background and waits until its first session is watching the working tree.
+void fsmonitorStart() {
+    if (!filesystem::exists(".mygit/")) {
+        cout << "Must initialize a mygit repository first using mygit init." << endl;
+        exit(1);
+    }
+
+    if (fsmonitorRunning()) {
+        cout << "fsmonitor is already running." << endl;
+        return;
+    }
+
+    filesystem::create_directories(FSMONITOR_DIRECTORY);
+    error_code ec;
+    filesystem::remove(FSMONITOR_DAEMON_PATH, ec);
+
+    cout.flush();
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        cout << "Failed to start fsmonitor." << endl;
+        exit(1);
+    }
+
+    if (pid == 0) {
+        setsid();
+
+        int devNull = open("/dev/null", O_RDWR);
+        dup2(devNull, STDIN_FILENO);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        close(devNull);
+
+        FsMonitorDaemon daemon;
+        daemon.run();
+        _exit(0);
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(FSMONITOR_START_TIMEOUT_SECONDS);
+    while (chrono::steady_clock::now() < deadline) {
+        int daemonPid;
+        string session;
+        if (readDaemonFile(daemonPid, session) && daemonPid == pid) {
+            cout << "fsmonitor started (pid " << pid << ")." << endl;
+            return;
+        }
+
+        int status;
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            break;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    kill(pid, SIGTERM);
+    cout << "Failed to start fsmonitor; the working tree may have more directories than inotify can watch." << endl;
+    exit(1);
+}
+
+
+
+
+void fsmonitorStop() {
+    int pid;
+    string session;
+    if (!readDaemonFile(pid, session) || kill(pid, SIGTERM) != 0) {
+        cout << "fsmonitor is not running." << endl;
+        return;
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while (filesystem::exists(FSMONITOR_DAEMON_PATH) && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    cout << "fsmonitor stopped." << endl;
+}
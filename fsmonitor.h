@@ -0,0 +1,80 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef FSMONITOR_H
+#define FSMONITOR_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+
+#include "util.h"
+#include "ignore.h"
+
+using namespace std;
+
+const string FSMONITOR_DIRECTORY = ".mygit/fsmonitor/";
+const string FSMONITOR_DAEMON_PATH = FSMONITOR_DIRECTORY + "daemon";
+const string FSMONITOR_COOKIE_PREFIX = "cookie-";
+
+//A change log larger than this is dropped and a new session started, which invalidates saved tokens.
+constexpr size_t FSMONITOR_MAX_LOG_BYTES = 64 * 1024 * 1024;
+constexpr int FSMONITOR_POLL_MILLISECONDS = 5000;
+constexpr int FSMONITOR_START_TIMEOUT_SECONDS = 60;
+constexpr int FSMONITOR_COOKIE_TIMEOUT_MILLISECONDS = 1000;
+
+
+//Watches the working tree with inotify and appends every changed path to a change log. Each run of watches
+//is a session; a token names a session and a position in its log, so the paths changed since a token are
+//the lines after that position. Ignored directories are not watched, so a change to the ignore rules or
+//an overflowed event queue starts a new session.
+class FsMonitorDaemon {
+public:
+    void run();
+
+private:
+    bool startSession();
+    void endSession();
+    bool watchDirectory(const string&);
+    void handleEvents(const char*, ssize_t);
+    void logPath(const string&);
+
+    int inotifyFd = -1;
+    int cookieWatch = -1;
+    int infoWatch = -1;
+    int sessionCount = 0;
+    string session;
+    FILE* changeLog = nullptr;
+    size_t logBytes = 0;
+    bool restart = false;
+    unordered_map<int, string> watchedDirectories;
+    unique_ptr<IgnoreMatcher> ignoreMatcher;
+};
+
+
+
+string changeLogPath(const string&);
+bool readDaemonFile(int&, string&);
+bool fsmonitorRunning();
+bool fsmonitorQuery(const string&, string&, vector<string>&);
+void fsmonitorStart();
+void fsmonitorStop();
+
+
+#endif //FSMONITOR_H
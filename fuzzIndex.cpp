@@ -0,0 +1,33 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+//libFuzzer target for the index parser. Arbitrary index contents must never crash parseIndexEntries,
+//and every entry it returns must have both a hash and a path.
+//Build with: clang++ -std=c++17 -g -fsanitize=fuzzer,address fuzzIndex.cpp util.cpp -lz -lcrypto
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "util.h"
+
+using namespace std;
+
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    istringstream index(string(reinterpret_cast<const char*>(data), size));
+
+    vector<IndexEntry> entries = parseIndexEntries(index);
+
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].hashString.empty() || entries[i].path.empty()) {
+            abort();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+//libFuzzer target for the zlib wrappers. Arbitrary input must never crash decompressUsingInflate, and
+//anything compressed with compressUsingDeflate must inflate back to the same bytes.
+//Build with: clang++ -std=c++17 -g -fsanitize=fuzzer,address fuzzInflate.cpp util.cpp -lz -lcrypto
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "util.h"
+
+using namespace std;
+
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    vector<unsigned char> input(data, data + size);
+
+    decompressUsingInflate(input);
+
+    vector<unsigned char> compressed = compressUsingDeflate(input);
+    if (decompressUsingInflate(compressed) != input) {
+        abort();
+    }
+
+    return 0;
+}
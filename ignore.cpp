@@ -0,0 +1,249 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "ignore.h"
+
+
+//Loads and compiles every rule in an ignore file. A missing file gives an empty rule set.
+void IgnoreRuleSet::load(const string& filePath) {
+    ifstream ignoreFile(filePath);
+    string line;
+
+    if (!ignoreFile.is_open()) {
+        return;
+    }
+
+    while (getline(ignoreFile, line)) {
+        addRule(line);
+    }
+
+    ignoreFile.close();
+}
+
+
+
+
+//Parses one line of an ignore file and files the rule under the index it can be found by.
+void IgnoreRuleSet::addRule(const string& line) {
+    string pattern = line;
+
+    if (!pattern.empty() && pattern.back() == '\r') {
+        pattern.pop_back();
+    }
+
+    //Trailing spaces are ignored unless escaped.
+    while (!pattern.empty() && pattern.back() == ' ' && (pattern.size() < 2 || pattern[pattern.size() - 2] != '\\')) {
+        pattern.pop_back();
+    }
+
+    if (pattern.empty() || pattern[0] == '#') {
+        return;
+    }
+
+    IgnoreRule rule;
+
+    if (pattern[0] == '!') {
+        rule.negated = true;
+        pattern = pattern.substr(1);
+    } else if (pattern[0] == '\\') {
+        pattern = pattern.substr(1);
+    }
+
+    if (!pattern.empty() && pattern.back() == '/') {
+        rule.directoryOnly = true;
+        pattern.pop_back();
+    }
+
+    if (pattern.rfind("**/", 0) == 0 && pattern.find('/', 3) == string::npos) {
+        pattern = pattern.substr(3);
+    }
+
+    if (!pattern.empty() && pattern[0] == '/') {
+        rule.anchored = true;
+        pattern = pattern.substr(1);
+    } else if (pattern.find('/') != string::npos) {
+        rule.anchored = true;
+    }
+
+    if (pattern.empty()) {
+        return;
+    }
+
+    rule.pattern = pattern;
+
+    const string wildcards = "*?[\\";
+    size_t firstWildcard = pattern.find_first_of(wildcards);
+    size_t lastWildcard = pattern.find_last_of(wildcards);
+
+    if (firstWildcard == string::npos) {
+        rule.kind = IgnoreKind::EXACT;
+        rule.literal = pattern;
+    } else if (!rule.anchored && firstWildcard == 0 && lastWildcard == 0 && pattern[0] == '*' && pattern.size() > 1) {
+        rule.kind = IgnoreKind::SUFFIX;
+        rule.literal = pattern.substr(1);
+    } else if (!rule.anchored && firstWildcard == pattern.size() - 1 && pattern.back() == '*' && pattern.size() > 1) {
+        rule.kind = IgnoreKind::PREFIX;
+        rule.literal = pattern.substr(0, pattern.size() - 1);
+    } else {
+        rule.kind = IgnoreKind::GLOB;
+    }
+
+    int index = rules.size();
+    rules.push_back(rule);
+
+    if (rule.anchored) {
+        globRules.push_back(index);
+    } else if (rule.kind == IgnoreKind::EXACT) {
+        exactRules[rule.literal].push_back(index);
+    } else if (rule.kind == IgnoreKind::PREFIX) {
+        prefixRules[rule.literal.front()].push_back(index);
+    } else if (rule.kind == IgnoreKind::SUFFIX) {
+        suffixRules[rule.literal.back()].push_back(index);
+    } else {
+        globRules.push_back(index);
+    }
+}
+
+
+
+
+//Tests a single rule. Anchored rules match the path relative to the ignore file, the rest match the file name.
+bool IgnoreRuleSet::ruleMatches(int index, const string& relativePath, const string& name, bool isDirectory) const {
+    const IgnoreRule& rule = rules[index];
+
+    if (rule.directoryOnly && !isDirectory) {
+        return false;
+    }
+
+    const string& target = rule.anchored ? relativePath : name;
+
+    switch (rule.kind) {
+        case IgnoreKind::EXACT:
+            return target == rule.literal;
+        case IgnoreKind::PREFIX:
+            return target.compare(0, rule.literal.size(), rule.literal) == 0;
+        case IgnoreKind::SUFFIX:
+            return target.size() >= rule.literal.size() &&
+                   target.compare(target.size() - rule.literal.size(), rule.literal.size(), rule.literal) == 0;
+        default:
+            return fnmatch(rule.pattern.c_str(), target.c_str(), rule.anchored ? FNM_PATHNAME : 0) == 0;
+    }
+}
+
+
+
+
+//Records the latest rule in a candidate list that matches. Rules later in the file take precedence.
+void IgnoreRuleSet::consider(const vector<int>& candidates, const string& relativePath, const string& name,
+                             bool isDirectory, int& best) const {
+    for (int i = candidates.size() - 1; i >= 0 && candidates[i] > best; i--) {
+        if (ruleMatches(candidates[i], relativePath, name, isDirectory)) {
+            best = candidates[i];
+            return;
+        }
+    }
+}
+
+
+
+
+//Matches a path (relative to the directory of this rule set) against the rules.
+IgnoreResult IgnoreRuleSet::match(const string& relativePath, const string& name, bool isDirectory) const {
+    if (rules.empty() || name.empty()) {
+        return IgnoreResult::NONE;
+    }
+
+    int best = -1;
+
+    auto exact = exactRules.find(name);
+    if (exact != exactRules.end()) {
+        consider(exact->second, relativePath, name, isDirectory, best);
+    }
+
+    auto prefix = prefixRules.find(name.front());
+    if (prefix != prefixRules.end()) {
+        consider(prefix->second, relativePath, name, isDirectory, best);
+    }
+
+    auto suffix = suffixRules.find(name.back());
+    if (suffix != suffixRules.end()) {
+        consider(suffix->second, relativePath, name, isDirectory, best);
+    }
+
+    consider(globRules, relativePath, name, isDirectory, best);
+
+    if (best < 0) {
+        return IgnoreResult::NONE;
+    }
+
+    return rules[best].negated ? IgnoreResult::INCLUDED : IgnoreResult::IGNORED;
+}
+
+
+
+
+bool IgnoreRuleSet::empty() const {
+    return rules.empty();
+}
+
+
+
+
+IgnoreMatcher::IgnoreMatcher() {
+    excludeRules.load(EXCLUDE_FILE_PATH);
+}
+
+
+
+
+//Returns the rules of the .mygitignore in a directory (relative to the repository root, "" for the root).
+const IgnoreRuleSet& IgnoreMatcher::rulesForDirectory(const string& directory) {
+    auto cached = directoryRules.find(directory);
+    if (cached != directoryRules.end()) {
+        return *cached->second;
+    }
+
+    unique_ptr<IgnoreRuleSet> ruleSet = make_unique<IgnoreRuleSet>();
+    ruleSet->load(directory.empty() ? IGNORE_FILE_NAME : directory + "/" + IGNORE_FILE_NAME);
+
+    return *directoryRules.emplace(directory, move(ruleSet)).first->second;
+}
+
+
+
+
+//Checks whether a path relative to the repository root is ignored. The closest .mygitignore with a matching
+//rule decides, then .mygit/info/exclude. Only the path itself is tested: callers walking the tree prune
+//ignored directories, so the files beneath them are never asked about.
+bool IgnoreMatcher::isIgnored(const string& path, bool isDirectory) {
+    if (path.empty() || path == ".") {
+        return false;
+    }
+
+    size_t nameStart = path.find_last_of('/');
+    string name = nameStart == string::npos ? path : path.substr(nameStart + 1);
+
+    if (name == ".mygit") {
+        return true;
+    }
+
+    //Walk from the directory holding the path up to the root.
+    size_t slash = nameStart;
+    while (true) {
+        string directory = slash == string::npos ? "" : path.substr(0, slash);
+        string relativePath = slash == string::npos ? path : path.substr(slash + 1);
+
+        IgnoreResult result = rulesForDirectory(directory).match(relativePath, name, isDirectory);
+        if (result != IgnoreResult::NONE) {
+            return result == IgnoreResult::IGNORED;
+        }
+
+        if (slash == string::npos) {
+            break;
+        }
+        slash = slash == 0 ? string::npos : path.find_last_of('/', slash - 1);
+    }
+
+    return excludeRules.match(path, name, isDirectory) == IgnoreResult::IGNORED;
+}
@@ -0,0 +1,70 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef IGNORE_H
+#define IGNORE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <unordered_map>
+#include <fnmatch.h>
+
+using namespace std;
+
+const string IGNORE_FILE_NAME = ".mygitignore";
+const string EXCLUDE_FILE_PATH = ".mygit/info/exclude";
+
+enum class IgnoreKind { EXACT, PREFIX, SUFFIX, GLOB };
+enum class IgnoreResult { NONE, IGNORED, INCLUDED };
+
+struct IgnoreRule {
+    string pattern;
+    IgnoreKind kind;
+    string literal;
+    bool negated = false;
+    bool directoryOnly = false;
+    bool anchored = false;
+};
+
+
+//The rules from one ignore file, compiled so a lookup only tests the rules that can possibly match.
+//Unanchored rules with no wildcards are found by hash, "*lit" and "lit*" rules are bucketed by the last
+//and first character of their literal, and only the rest fall back to fnmatch.
+class IgnoreRuleSet {
+public:
+    void load(const string&);
+    void addRule(const string&);
+    IgnoreResult match(const string&, const string&, bool) const;
+    bool empty() const;
+
+private:
+    bool ruleMatches(int, const string&, const string&, bool) const;
+    void consider(const vector<int>&, const string&, const string&, bool, int&) const;
+
+    vector<IgnoreRule> rules;
+    unordered_map<string, vector<int>> exactRules;
+    unordered_map<char, vector<int>> prefixRules;
+    unordered_map<char, vector<int>> suffixRules;
+    vector<int> globRules;
+};
+
+
+//Answers whether a path is ignored, using the .mygitignore of every directory above it and .mygit/info/exclude.
+//Rule sets are loaded once per directory and kept for the life of the matcher.
+class IgnoreMatcher {
+public:
+    IgnoreMatcher();
+    bool isIgnored(const string&, bool);
+
+private:
+    const IgnoreRuleSet& rulesForDirectory(const string&);
+
+    unordered_map<string, unique_ptr<IgnoreRuleSet>> directoryRules;
+    IgnoreRuleSet excludeRules;
+};
+
+
+#endif //IGNORE_H
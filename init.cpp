@@ -16,14 +16,20 @@ void createRootPaths() {
         string objectsPath = repoPath + "objects/";
         string refsPath = repoPath + "refs/";
         string headsRefsPath = refsPath + "heads/";
+        string infoPath = repoPath + "info/";
 
         filesystem::create_directory(objectsPath);
         filesystem::create_directory(refsPath);
         filesystem::create_directory(headsRefsPath);
+        filesystem::create_directory(infoPath);
 
         ofstream headFile (repoPath + "HEAD");
         ofstream indexFile (repoPath + "index");
         ofstream refsFile (headsRefsPath + "main");
+        ofstream excludeFile (infoPath + "exclude");
+
+        excludeFile << "# Patterns to ignore in this repository only, in .mygitignore format." << endl;
+        excludeFile.close();
 
         //Write current state to HEAD file
         indexFile.close();
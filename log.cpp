@@ -0,0 +1,574 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "log.h"
+
+
+//Opens the pager when writing to a terminal, otherwise writes straight to stdout.
+PagedOutput::PagedOutput() : out(stdout) {
+    //A pager that quits early must end the walk through a failed write, not kill the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!isatty(STDOUT_FILENO)) {
+        return;
+    }
+
+    const char* pager = getenv("MYGIT_PAGER");
+    if (pager == nullptr) {
+        pager = getenv("PAGER");
+    }
+    if (pager == nullptr) {
+        pager = "less -FRX";
+    }
+
+    if (string(pager).empty() || string(pager) == "cat") {
+        return;
+    }
+
+    cout.flush();
+    FILE* pagerPipe = popen(pager, "w");
+    if (pagerPipe != nullptr) {
+        out = pagerPipe;
+        usingPager = true;
+    }
+}
+
+
+
+
+//Writes whatever is left and waits for the pager to exit.
+PagedOutput::~PagedOutput() {
+    flush();
+
+    if (usingPager) {
+        pclose(out);
+    } else {
+        fflush(out);
+    }
+}
+
+
+
+
+//Appends text to the buffer, writing it out once the buffer is full. Returns false once the reader is gone.
+bool PagedOutput::write(const string& text) {
+    if (broken) {
+        return false;
+    }
+
+    buffer += text;
+
+    if (buffer.size() >= LOG_BUFFER_SIZE) {
+        return flush();
+    }
+
+    return true;
+}
+
+
+
+
+//Writes the buffer out. Blocks while the pager is not reading, so output is only produced as it is read.
+bool PagedOutput::flush() {
+    if (broken) {
+        return false;
+    }
+
+    if (!buffer.empty()) {
+        if (fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size() || fflush(out) != 0) {
+            broken = true;
+        }
+        buffer.clear();
+    }
+
+    return !broken;
+}
+
+
+
+
+//Parses the commit limit of -n, -<n> and --max-count. Only a plain non-negative number is accepted.
+bool parseCount(const string& text, int& count) {
+    if (text.empty() || text.size() > 9 || !all_of(text.begin(), text.end(), ::isdigit)) {
+        cout << "Invalid count: " << text << endl;
+        return false;
+    }
+
+    count = stoi(text);
+    return true;
+}
+
+
+
+
+//Parses log arguments starting at argv[start]. Returns false on an unknown or malformed argument.
+bool parseLogOptions(int argc, char* argv[], int start, LogOptions& options) {
+    for (int i = start; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg == "--") {
+            options.paths.insert(options.paths.end(), argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "-n" && i + 1 < argc) {
+            if (!parseCount(argv[++i], options.maxCount)) {
+                return false;
+            }
+        } else if (arg.rfind("-n", 0) == 0 && arg.size() > 2) {
+            if (!parseCount(arg.substr(2), options.maxCount)) {
+                return false;
+            }
+        } else if (arg.rfind("--max-count=", 0) == 0) {
+            if (!parseCount(arg.substr(12), options.maxCount)) {
+                return false;
+            }
+        } else if (arg.size() > 1 && arg[0] == '-' && isdigit((unsigned char) arg[1])) {
+            if (!parseCount(arg.substr(1), options.maxCount)) {
+                return false;
+            }
+        } else if (arg == "--graph") {
+            options.graph = true;
+        } else if (arg == "--oneline") {
+            options.format = "%h %s";
+        } else if (arg.rfind("--format=", 0) == 0) {
+            options.format = arg.substr(9);
+        } else if (arg.rfind("--since=", 0) == 0) {
+            options.since = parseDate(arg.substr(8));
+        } else if (arg.rfind("--until=", 0) == 0) {
+            options.until = parseDate(arg.substr(8));
+        } else {
+            cout << "Unknown log option: " << arg << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+//Parses a date given either as a unix timestamp or as YYYY-MM-DD (UTC).
+long long parseDate(const string& date) {
+    if (!date.empty() && date.find_first_not_of("0123456789") == string::npos) {
+        return atoll(date.c_str());
+    }
+
+    tm parsed{};
+    if (sscanf(date.c_str(), "%d-%d-%d", &parsed.tm_year, &parsed.tm_mon, &parsed.tm_mday) != 3) {
+        cout << "Invalid date: " << date << endl;
+        exit(1);
+    }
+
+    parsed.tm_year -= 1900;
+    parsed.tm_mon -= 1;
+
+    return timegm(&parsed);
+}
+
+
+
+
+//Formats a unix time the way git prints dates.
+string formatDate(long long time) {
+    time_t t = time;
+    tm utc{};
+    gmtime_r(&t, &utc);
+
+    char formatted[64];
+    strftime(formatted, sizeof(formatted), "%a %b %d %H:%M:%S %Y +0000", &utc);
+    return formatted;
+}
+
+
+
+
+//Expands a --format string for one commit. Supports %H %h %T %t %P %p %an %ae %ad %at %cn %ce %cd %ct %s %b %n %%.
+string formatCommit(const CommitInfo& commit, const string& format) {
+    string result;
+
+    size_t emailStart = commit.author.find(" <");
+    string authorName = commit.author.substr(0, emailStart);
+    string authorEmail = emailStart == string::npos ? "" : commit.author.substr(emailStart + 2, commit.author.size() - emailStart - 3);
+
+    emailStart = commit.committer.find(" <");
+    string committerName = commit.committer.substr(0, emailStart);
+    string committerEmail = emailStart == string::npos ? "" : commit.committer.substr(emailStart + 2, commit.committer.size() - emailStart - 3);
+
+    size_t subjectEnd = commit.message.find('\n');
+    string subject = commit.message.substr(0, subjectEnd);
+    string body = subjectEnd == string::npos ? "" : commit.message.substr(subjectEnd + 1);
+
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%' || i + 1 == format.size()) {
+            result += format[i];
+            continue;
+        }
+
+        char code = format[++i];
+        char detail = i + 1 < format.size() ? format[i + 1] : '\0';
+
+        if (code == 'H') {
+            result += commit.hash;
+        } else if (code == 'h') {
+            result += commit.hash.substr(0, 7);
+        } else if (code == 'T') {
+            result += commit.tree;
+        } else if (code == 't') {
+            result += commit.tree.substr(0, 7);
+        } else if (code == 'P' || code == 'p') {
+            for (int p = 0; p < commit.parents.size(); p++) {
+                result += (p > 0 ? " " : "") + (code == 'P' ? commit.parents[p] : commit.parents[p].substr(0, 7));
+            }
+        } else if ((code == 'a' || code == 'c') && string("nedt").find(detail) != string::npos && detail != '\0') {
+            bool isAuthor = code == 'a';
+            i++;
+
+            if (detail == 'n') {
+                result += isAuthor ? authorName : committerName;
+            } else if (detail == 'e') {
+                result += isAuthor ? authorEmail : committerEmail;
+            } else if (detail == 'd') {
+                result += formatDate(isAuthor ? commit.authorTime : commit.commitTime);
+            } else {
+                result += to_string(isAuthor ? commit.authorTime : commit.commitTime);
+            }
+        } else if (code == 's') {
+            result += subject;
+        } else if (code == 'b') {
+            result += body;
+        } else if (code == 'n') {
+            result += '\n';
+        } else if (code == '%') {
+            result += '%';
+        } else {
+            result += '%';
+            result += code;
+        }
+    }
+
+    return result;
+}
+
+
+
+
+//Checks whether a commit changed any of the paths compared to its parents. A commit that leaves the paths
+//the same as one of its parents is skipped, as git does. Parent commits read here are kept for the walk.
+bool commitTouchesPaths(const CommitInfo& commit, const vector<string>& paths,
+                        unordered_map<string, CommitInfo>& commits) {
+    if (commit.parents.empty()) {
+        for (int i = 0; i < paths.size(); i++) {
+            if (!lookupPathInTree(commit.tree, paths[i]).empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (int p = 0; p < commit.parents.size(); p++) {
+        auto parent = commits.find(commit.parents[p]);
+        if (parent == commits.end()) {
+            CommitInfo info;
+            if (!readCommit(commit.parents[p], info)) {
+                continue;
+            }
+            parent = commits.emplace(commit.parents[p], info).first;
+        }
+
+        bool changed = false;
+        for (int i = 0; i < paths.size() && !changed; i++) {
+            changed = pathChangedBetweenTrees(commit.tree, parent->second.tree, paths[i]);
+        }
+
+        if (!changed) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+//Draws the rows of log --graph for one commit. Only the columns of the lines currently passing through the
+//output are kept, so each commit is drawn as soon as it is reached, however long the history is.
+//Returns the commit row followed by the text, then a row showing how the lines move to the commit's parents.
+string GraphRenderer::render(const string& hash, const vector<string>& parents, const string& text) {
+    auto found = find(columns.begin(), columns.end(), hash);
+    size_t column = found - columns.begin();
+    if (found == columns.end()) {
+        columns.push_back(hash);
+    }
+
+    //The commit row, with the first line of the text beside it.
+    istringstream lines(text);
+    string line;
+    getline(lines, line);
+
+    string result;
+    for (size_t i = 0; i < columns.size(); i++) {
+        result += i == column ? "* " : "| ";
+    }
+    result += line + "\n";
+
+    //Work out where every line goes: the commit's column becomes its parents, other columns that were also
+    //waiting for this commit join it, and a parent that already has a column is joined rather than repeated.
+    vector<string> nextColumns;
+    for (size_t i = 0; i < columns.size(); i++) {
+        vector<string> incoming = i == column ? parents : vector<string>();
+        if (i != column && columns[i] != hash) {
+            incoming.push_back(columns[i]);
+        }
+
+        for (int c = 0; c < incoming.size(); c++) {
+            bool laterColumn = i == column && find(columns.begin() + i + 1, columns.end(), incoming[c]) != columns.end();
+            if (!laterColumn && find(nextColumns.begin(), nextColumns.end(), incoming[c]) == nextColumns.end()) {
+                nextColumns.push_back(incoming[c]);
+            }
+        }
+    }
+
+    auto newColumn = [&](const string& target) -> size_t {
+        return find(nextColumns.begin(), nextColumns.end(), target) - nextColumns.begin();
+    };
+
+    vector<pair<size_t, size_t>> moves;
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (i == column) {
+            for (int p = 0; p < parents.size(); p++) {
+                moves.push_back(make_pair(i, newColumn(parents[p])));
+            }
+        } else if (columns[i] != hash) {
+            moves.push_back(make_pair(i, newColumn(columns[i])));
+        } else if (!parents.empty()) {
+            moves.push_back(make_pair(i, newColumn(parents[0])));
+        }
+    }
+
+    bool straight = parents.size() == 1 && nextColumns.size() == columns.size();
+    for (int i = 0; i < moves.size() && straight; i++) {
+        straight = moves[i].first == moves[i].second;
+    }
+
+    if (!straight && !moves.empty()) {
+        size_t width = 2 * max(columns.size(), nextColumns.size());
+        string row(width, ' ');
+
+        for (int i = 0; i < moves.size(); i++) {
+            size_t from = 2 * moves[i].first;
+            size_t to = 2 * moves[i].second;
+
+            if (from == to) {
+                row[from] = '|';
+            } else if (to < from) {
+                row[from - 1] = '/';
+                for (size_t c = to + 1; c + 1 < from; c++) {
+                    row[c] = '_';
+                }
+            } else {
+                row[from + 1] = '\\';
+                for (size_t c = from + 2; c < to; c++) {
+                    row[c] = '_';
+                }
+            }
+        }
+
+        row.erase(row.find_last_not_of(' ') + 1);
+        result += row + "\n";
+    }
+
+    columns = nextColumns;
+
+    //The rest of the text, beside the lines passing through.
+    string padding;
+    for (size_t i = 0; i < columns.size(); i++) {
+        padding += "| ";
+    }
+
+    while (getline(lines, line)) {
+        result += padding + line + "\n";
+    }
+
+    return result;
+}
+
+
+
+
+//Passes over a commit that is not shown. The line waiting for it now leads to its parents instead, so a
+//shown child is joined to its nearest shown ancestors rather than to a commit that never appears.
+void GraphRenderer::skip(const string& hash, const vector<string>& parents) {
+    auto found = find(columns.begin(), columns.end(), hash);
+    if (found == columns.end()) {
+        return;
+    }
+
+    vector<string> nextColumns;
+    for (size_t i = 0; i < columns.size(); i++) {
+        vector<string> incoming = columns[i] == hash ? parents : vector<string>{columns[i]};
+
+        for (int c = 0; c < incoming.size(); c++) {
+            if (find(nextColumns.begin(), nextColumns.end(), incoming[c]) == nextColumns.end()) {
+                nextColumns.push_back(incoming[c]);
+            }
+        }
+    }
+
+    columns = nextColumns;
+}
+
+
+
+
+//Logs previous commits, newest first. Commits are walked through a priority queue ordered by commit time
+//so merged histories interleave correctly, and the walk stops once the limit is reached or the reader quits.
+//With --graph the queue is ordered by generation number instead: every child has a higher generation than
+//its parents, so commits come out in topological order without first walking the whole history.
+//Without a commit-graph, a bounded lookahead window keeps children ahead of their parents.
+void commitLog(LogOptions& options) {
+    ifstream headFile(".mygit/HEAD");
+    string headCommit = readRef(".mygit/" + parseHeadForBranch(headFile));
+
+    if (headCommit.empty()) {
+        cout << "No commits yet" << endl;
+        return;
+    }
+
+    unordered_map<string, CommitInfo> commits;
+    unordered_set<string> queued;
+    //Ordered by commit time (or generation); ties go to the newer commit, then to the commit queued first,
+    //so parents never come before their children.
+    priority_queue<tuple<long long, long long, long long, string>> walk;
+    long long queuedCount = 0;
+    CommitGraph graph;
+    GraphRenderer renderer;
+
+    //Generation numbers are only used when the commit-graph already covers HEAD. Otherwise building it would
+    //read the whole history before the first line is printed, so the graph is ordered by commit time and up
+    //to LOG_LOOKAHEAD_WINDOW commits are held back, each drawn only once the children queued with it are.
+    bool generations = options.graph && graph.contains(headCommit);
+    size_t window = options.graph && !generations ? LOG_LOOKAHEAD_WINDOW : 0;
+    map<tuple<long long, long long, long long, string>, CommitInfo> held;
+    unordered_map<string, int> unshownChildren;
+
+    auto order = [&](const CommitInfo& commit) -> long long {
+        if (!generations) {
+            return commit.commitTime;
+        }
+        const GraphNode* node = graph.node(commit.hash);
+        return node == nullptr ? 0 : node->generation;
+    };
+
+    CommitInfo head;
+    if (!readCommit(headCommit, head)) {
+        cout << "Failed to open commit object " << headCommit << endl;
+        return;
+    }
+
+    commits.emplace(headCommit, head);
+    queued.insert(headCommit);
+    walk.push(make_tuple(order(head), head.commitTime, -queuedCount++, headCommit));
+
+    PagedOutput output;
+    int shown = 0;
+
+    while (options.maxCount < 0 || shown < options.maxCount) {
+        if (!walk.empty() && held.size() <= window) {
+            auto key = walk.top();
+            string hash = get<3>(key);
+            walk.pop();
+
+            CommitInfo commit = commits[hash];
+            commits.erase(hash);
+
+            //Everything left in the queue is older, so nothing more can match.
+            if (commit.commitTime < options.since && !options.graph) {
+                break;
+            }
+
+            for (int p = 0; p < commit.parents.size(); p++) {
+                if (window > 0) {
+                    unshownChildren[commit.parents[p]]++;
+                }
+
+                if (!queued.insert(commit.parents[p]).second) {
+                    continue;
+                }
+
+                if (commits.find(commit.parents[p]) == commits.end()) {
+                    CommitInfo parent;
+                    if (!readCommit(commit.parents[p], parent)) {
+                        cout << "Failed to open commit object " << commit.parents[p] << endl;
+                        continue;
+                    }
+                    commits.emplace(commit.parents[p], parent);
+                }
+
+                const CommitInfo& parent = commits[commit.parents[p]];
+                walk.push(make_tuple(order(parent), parent.commitTime, -queuedCount++, commit.parents[p]));
+            }
+
+            held.emplace(key, commit);
+            continue;
+        }
+
+        if (held.empty()) {
+            break;
+        }
+
+        //The newest held commit whose children have all been drawn. If clock skew is larger than the
+        //window, the newest one is drawn anyway.
+        auto next = prev(held.end());
+        for (auto it = held.rbegin(); it != held.rend(); ++it) {
+            if (unshownChildren[get<3>(it->first)] == 0) {
+                next = prev(it.base());
+                break;
+            }
+        }
+
+        string hash = get<3>(next->first);
+        CommitInfo commit = next->second;
+        held.erase(next);
+        unshownChildren.erase(hash);
+
+        for (int p = 0; p < commit.parents.size() && window > 0; p++) {
+            unshownChildren[commit.parents[p]]--;
+        }
+
+        if (commit.commitTime > options.until || commit.commitTime < options.since ||
+            (!options.paths.empty() && !commitTouchesPaths(commit, options.paths, commits))) {
+            if (options.graph) {
+                renderer.skip(hash, commit.parents);
+            }
+            continue;
+        }
+
+        string entry;
+        if (options.format.empty()) {
+            entry = formatCommit(commit, "commit %H\nAuthor: %an <%ae>\nDate:   %ad\n\n");
+
+            istringstream message(commit.message);
+            string line;
+            while (getline(message, line)) {
+                entry += "    " + line + "\n";
+            }
+            entry += "\n";
+        } else {
+            entry = formatCommit(commit, options.format) + "\n";
+        }
+
+        if (options.graph) {
+            entry = renderer.render(hash, commit.parents, entry);
+        }
+
+        if (!output.write(entry)) {
+            break;
+        }
+
+        shown++;
+    }
+
+    graph.save();
+}
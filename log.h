@@ -0,0 +1,84 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <ctime>
+#include <csignal>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h>
+
+#include "util.h"
+#include "commit.h"
+#include "tree.h"
+#include "commitGraph.h"
+
+using namespace std;
+
+constexpr size_t LOG_BUFFER_SIZE = 65536;
+
+//Commits log --graph holds back to keep children ahead of parents when there are no generation numbers.
+constexpr size_t LOG_LOOKAHEAD_WINDOW = 64;
+
+struct LogOptions {
+    int maxCount = -1;
+    string format;
+    long long since = 0;
+    long long until = LLONG_MAX;
+    vector<string> paths;
+    bool graph = false;
+};
+
+
+//Buffers output and hands it to a pager (or stdout) in large writes. Once the reader goes away
+//the output becomes broken and the caller can stop producing more.
+class PagedOutput {
+public:
+    PagedOutput();
+    ~PagedOutput();
+
+    bool write(const string&);
+    bool flush();
+
+private:
+    FILE* out;
+    bool usingPager = false;
+    bool broken = false;
+    string buffer;
+};
+
+
+//Keeps the lines of log --graph between commits. Each column holds the commit its line leads to.
+class GraphRenderer {
+public:
+    string render(const string&, const vector<string>&, const string&);
+    void skip(const string&, const vector<string>&);
+
+private:
+    vector<string> columns;
+};
+
+
+
+bool parseCount(const string&, int&);
+bool parseLogOptions(int, char*[], int, LogOptions&);
+long long parseDate(const string&);
+string formatDate(long long);
+string formatCommit(const CommitInfo&, const string&);
+bool commitTouchesPaths(const CommitInfo&, const vector<string>&, unordered_map<string, CommitInfo>&);
+void commitLog(LogOptions&);
+
+
+#endif //LOG_H
@@ -6,41 +6,141 @@
 #include "commit.h"
 #include "add.h"
 #include "config.h"
+#include "log.h"
+#include "merge.h"
+#include "plumbing.h"
+#include "shallow.h"
+#include "bundle.h"
+#include "status.h"
+#include "fsmonitor.h"
 
 using namespace std;
 
 
 int main(int argc, char* argv[]) {
-    cout << "Running mygit" << endl;
-
     if (argc < 2) {
+        cout << "Running mygit" << endl;
         cout << "Usage: ./mygit [argument]" << endl;
         return 1;
     }
 
     string command = argv[1];
 
+    //Plumbing commands are read by scripts, and bundles can be written to stdout, so their output
+    //must be only the requested data.
+    bool plumbing = command == "cat-file" || command == "ls-tree" || command == "hash-object" || command == "bundle";
+    if (!plumbing) {
+        cout << "Running mygit" << endl;
+    }
+
     if (command == "init") {
         init();
     } else if (command == "add") {
-        string fileToAdd = argv[2];
-        add(fileToAdd);
-    } else if (command == "commit") {
         if (argc < 3) {
-            cout << "Usage: ./mygit commit -m [message]" << endl;
+            cout << "Usage: ./mygit add [files...]" << endl;
+            return 1;
+        }
+
+        vector<string> filesToAdd(argv + 2, argv + argc);
+        add(filesToAdd);
+    } else if (command == "commit") {
+        bool all = argc > 2 && string(argv[2]) == "-a";
+        if (argc < 3 + all) {
+            cout << "Usage: ./mygit commit [-a] -m [message]" << endl;
             return 1;
         }
 
         string commitMessage;
-        for (int i = 3; i < argc; i++) {
+        for (int i = 3 + all; i < argc; i++) {
             commitMessage += string(argv[i]) + " ";
         }
 
+        if (all) {
+            addTrackedChanges();
+        }
+
         commit(commitMessage);
 
+    } else if (command == "status") {
+        status();
+    } else if (command == "fsmonitor") {
+        string subcommand = argc > 2 ? argv[2] : "";
+
+        if (subcommand == "start") {
+            fsmonitorStart();
+        } else if (subcommand == "stop") {
+            fsmonitorStop();
+        } else {
+            cout << "Usage: ./mygit fsmonitor start | fsmonitor stop" << endl;
+            return 1;
+        }
     } else if (command == "config") {
         config();
     } else if (command == "log") {
-        commitLog();
+        LogOptions options;
+        if (!parseLogOptions(argc, argv, 2, options)) {
+            cout << "Usage: ./mygit log [-n count | -<count>] [--graph] [--oneline] [--format=format] [--since=date] [--until=date] [-- paths...]" << endl;
+            return 1;
+        }
+
+        commitLog(options);
+    } else if (command == "merge-base") {
+        if (argc < 4) {
+            cout << "Usage: ./mygit merge-base [commit] [commit]" << endl;
+            return 1;
+        }
+
+        printMergeBase(argv[2], argv[3]);
+    } else if (command == "merge") {
+        if (argc < 3) {
+            cout << "Usage: ./mygit merge [branch]" << endl;
+            return 1;
+        }
+
+        merge(argv[2]);
+    } else if (command == "shallow") {
+        bool prune = argc > 2 && string(argv[2]) == "--prune";
+        if (argc < 3 + prune) {
+            cout << "Usage: ./mygit shallow [--prune] [commit]" << endl;
+            return 1;
+        }
+
+        shallow(argv[2 + prune], prune);
+    } else if (command == "bundle") {
+        string subcommand = argc > 2 ? argv[2] : "";
+
+        if (subcommand == "create" && argc >= 5) {
+            createBundle(argv[3], vector<string>(argv + 4, argv + argc));
+        } else if (subcommand == "unbundle" && (argc == 4 || (argc == 5 && string(argv[3]) == "--force"))) {
+            unbundle(argv[argc - 1], argc == 5);
+        } else {
+            cout << "Usage: ./mygit bundle create [file | -] [branches...] | bundle unbundle [--force] [file | -]" << endl;
+            return 1;
+        }
+    } else if (command == "cat-file") {
+        if (argc == 3 && (string(argv[2]) == "--batch" || string(argv[2]) == "--batch-check")) {
+            catFileBatch(string(argv[2]) == "--batch");
+        } else if (argc == 4) {
+            catFile(argv[2], argv[3]);
+        } else {
+            cout << "Usage: ./mygit cat-file (-t | -s | -p) [object] | --batch | --batch-check" << endl;
+            return 1;
+        }
+    } else if (command == "ls-tree") {
+        bool recursive = argc > 2 && string(argv[2]) == "-r";
+        if (argc < 3 + recursive) {
+            cout << "Usage: ./mygit ls-tree [-r] [tree-ish]" << endl;
+            return 1;
+        }
+
+        lsTree(argv[2 + recursive], recursive);
+    } else if (command == "hash-object") {
+        bool write = argc > 2 && string(argv[2]) == "-w";
+        if (argc < 3 + write) {
+            cout << "Usage: ./mygit hash-object [-w] [file]" << endl;
+            return 1;
+        }
+
+        hashObject(argv[2 + write], write);
     }
 }
@@ -0,0 +1,556 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "merge.h"
+
+constexpr int FROM_ONE = 1;
+constexpr int FROM_TWO = 2;
+constexpr int STALE = 4;
+
+
+//Finds the best common ancestor of two commits. Both sides are walked together, always expanding the commit
+//with the highest generation number, and each commit is marked with the sides it is reachable from.
+//A commit reached from both sides is a merge base; everything below it is marked stale, and the walk ends
+//as soon as only stale commits are queued, so history below the merge base is never visited.
+string mergeBase(const string& one, const string& two, CommitGraph& graph) {
+    if (one == two) {
+        return one;
+    }
+
+    const GraphNode* nodeOne = graph.node(one);
+    const GraphNode* nodeTwo = graph.node(two);
+    if (nodeOne == nullptr || nodeTwo == nullptr) {
+        return "";
+    }
+
+    unordered_map<string, int> flags;
+    set<pair<int, string>> queue;
+    int nonStaleQueued = 0;
+    vector<string> results;
+
+    //Adds flags to a commit, (re)queueing it if they changed.
+    auto mark = [&](const string& hash, int generation, int newFlags) {
+        int& current = flags[hash];
+        if ((current | newFlags) == current) {
+            return;
+        }
+
+        bool wasQueued = queue.count(make_pair(generation, hash)) > 0;
+        if (wasQueued && !(current & STALE)) {
+            nonStaleQueued--;
+        }
+
+        current |= newFlags;
+        queue.insert(make_pair(generation, hash));
+
+        if (!(current & STALE)) {
+            nonStaleQueued++;
+        }
+    };
+
+    mark(one, nodeOne->generation, FROM_ONE);
+    mark(two, nodeTwo->generation, FROM_TWO);
+
+    while (nonStaleQueued > 0) {
+        auto highest = prev(queue.end());
+        string hash = highest->second;
+        queue.erase(highest);
+
+        int commitFlags = flags[hash];
+        if (!(commitFlags & STALE)) {
+            nonStaleQueued--;
+        }
+
+        int parentFlags = commitFlags & (FROM_ONE | FROM_TWO | STALE);
+
+        if ((commitFlags & (FROM_ONE | FROM_TWO)) == (FROM_ONE | FROM_TWO) && !(commitFlags & STALE)) {
+            results.push_back(hash);
+            parentFlags |= STALE;
+        }
+
+        const GraphNode* node = graph.node(hash);
+        if (node == nullptr) {
+            continue;
+        }
+
+        for (int i = 0; i < node->parents.size(); i++) {
+            const GraphNode* parent = graph.node(node->parents[i]);
+            if (parent != nullptr) {
+                mark(parent->hash, parent->generation, parentFlags);
+            }
+        }
+    }
+
+    graph.save();
+
+    //The first result has the highest generation, the one git merge-base prints without --all.
+    return results.empty() ? "" : results[0];
+}
+
+
+
+
+//Splits text into lines, keeping each line's newline.
+vector<string> splitLines(const string& text) {
+    vector<string> lines;
+    size_t start = 0;
+
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        end = end == string::npos ? text.size() : end + 1;
+        lines.push_back(text.substr(start, end - start));
+        start = end;
+    }
+
+    return lines;
+}
+
+
+
+
+//Matches the lines of a against the lines of b with a longest common subsequence. Returns, for every line of a,
+//the index of its matching line in b or -1. Common leading and trailing lines are matched directly so the
+//table only covers the changed middle; a middle too large for the table is left unmatched.
+vector<int> matchLines(const vector<string>& a, const vector<string>& b) {
+    vector<int> matches(a.size(), -1);
+
+    size_t prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+        matches[prefix] = prefix;
+        prefix++;
+    }
+
+    size_t suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+           a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) {
+        matches[a.size() - 1 - suffix] = b.size() - 1 - suffix;
+        suffix++;
+    }
+
+    size_t n = a.size() - prefix - suffix;
+    size_t m = b.size() - prefix - suffix;
+
+    if (n == 0 || m == 0 || (n + 1) * (m + 1) > MAX_LINE_MERGE_CELLS) {
+        return matches;
+    }
+
+    //lengths[i][j] is the LCS length of a[prefix + i..] and b[prefix + j..] within the middle.
+    vector<int> lengths((n + 1) * (m + 1), 0);
+    for (size_t i = n; i-- > 0;) {
+        for (size_t j = m; j-- > 0;) {
+            if (a[prefix + i] == b[prefix + j]) {
+                lengths[i * (m + 1) + j] = lengths[(i + 1) * (m + 1) + j + 1] + 1;
+            } else {
+                lengths[i * (m + 1) + j] = max(lengths[(i + 1) * (m + 1) + j], lengths[i * (m + 1) + j + 1]);
+            }
+        }
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < n && j < m) {
+        if (a[prefix + i] == b[prefix + j]) {
+            matches[prefix + i] = prefix + j;
+            i++;
+            j++;
+        } else if (lengths[(i + 1) * (m + 1) + j] >= lengths[i * (m + 1) + j + 1]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+
+    return matches;
+}
+
+
+
+
+//Reads the contents of a blob. Returns an empty string for an empty hash.
+string readBlob(const string& hash) {
+    string type;
+    string content;
+
+    if (!hash.empty() && (!readObject(hash, type, content) || type != "blob")) {
+        cout << "Failed to read blob " << hash << endl;
+        exit(1);
+    }
+
+    return content;
+}
+
+
+
+
+//Three-way merges file contents line by line. Sections changed on only one side take that side; sections
+//changed differently on both sides are written between conflict markers. Returns true if there were no conflicts.
+bool mergeLines(const string& base, const string& ours, const string& theirs, const string& theirsLabel, string& result) {
+    vector<string> baseLines = splitLines(base);
+    vector<string> ourLines = splitLines(ours);
+    vector<string> theirLines = splitLines(theirs);
+
+    vector<int> ourMatches = matchLines(baseLines, ourLines);
+    vector<int> theirMatches = matchLines(baseLines, theirLines);
+
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+    bool clean = true;
+    result.clear();
+
+    while (i < baseLines.size() || j < ourLines.size() || k < theirLines.size()) {
+        //A base line kept in place on both sides is copied through.
+        if (i < baseLines.size() && ourMatches[i] == (int)j && theirMatches[i] == (int)k) {
+            result += baseLines[i];
+            i++;
+            j++;
+            k++;
+            continue;
+        }
+
+        //Otherwise find the next base line both sides kept; everything before it is a changed section.
+        size_t nextI = i;
+        while (nextI < baseLines.size() && (ourMatches[nextI] < (int)j || theirMatches[nextI] < (int)k)) {
+            nextI++;
+        }
+
+        size_t nextJ = nextI < baseLines.size() ? ourMatches[nextI] : ourLines.size();
+        size_t nextK = nextI < baseLines.size() ? theirMatches[nextI] : theirLines.size();
+
+        vector<string> baseSection(baseLines.begin() + i, baseLines.begin() + nextI);
+        vector<string> ourSection(ourLines.begin() + j, ourLines.begin() + nextJ);
+        vector<string> theirSection(theirLines.begin() + k, theirLines.begin() + nextK);
+
+        if (ourSection == baseSection || ourSection == theirSection) {
+            for (int line = 0; line < theirSection.size(); line++) {
+                result += theirSection[line];
+            }
+        } else if (theirSection == baseSection) {
+            for (int line = 0; line < ourSection.size(); line++) {
+                result += ourSection[line];
+            }
+        } else {
+            clean = false;
+            result += "<<<<<<< ours\n";
+            for (int line = 0; line < ourSection.size(); line++) {
+                result += ourSection[line];
+            }
+            if (!result.empty() && result.back() != '\n') {
+                result += '\n';
+            }
+            result += "=======\n";
+            for (int line = 0; line < theirSection.size(); line++) {
+                result += theirSection[line];
+            }
+            if (!result.empty() && result.back() != '\n') {
+                result += '\n';
+            }
+            result += ">>>>>>> " + theirsLabel + "\n";
+        }
+
+        i = nextI;
+        j = nextJ;
+        k = nextK;
+    }
+
+    return clean;
+}
+
+
+
+
+//Three-way merges two trees against their merge base and writes the result, returning its hash.
+//Whenever two of the three sides have the same hash the answer is known without reading anything, so only
+//subtrees changed on both sides are ever read. Conflicted paths are appended to conflicts and stored with markers.
+string mergeTrees(const string& baseTree, const string& ourTree, const string& theirTree, const string& prefix,
+                  const string& theirsLabel, vector<string>& conflicts, ObjectWriter& writer) {
+    if (ourTree == theirTree || baseTree == theirTree) {
+        return ourTree;
+    }
+    if (baseTree == ourTree) {
+        return theirTree;
+    }
+
+    map<string, TreeEntry> baseEntries;
+    map<string, TreeEntry> ourEntries;
+    map<string, TreeEntry> theirEntries;
+    map<string, TreeEntry> merged;
+
+    vector<TreeEntry> entries = baseTree.empty() ? vector<TreeEntry>() : readTree(baseTree);
+    for (int i = 0; i < entries.size(); i++) {
+        baseEntries[entries[i].name] = entries[i];
+    }
+    entries = ourTree.empty() ? vector<TreeEntry>() : readTree(ourTree);
+    for (int i = 0; i < entries.size(); i++) {
+        ourEntries[entries[i].name] = entries[i];
+        merged[entries[i].name] = entries[i];
+    }
+    entries = theirTree.empty() ? vector<TreeEntry>() : readTree(theirTree);
+    for (int i = 0; i < entries.size(); i++) {
+        theirEntries[entries[i].name] = entries[i];
+    }
+
+    //Every name on either side, including ones deleted on one side.
+    set<string> names;
+    for (auto it = baseEntries.begin(); it != baseEntries.end(); ++it) names.insert(it->first);
+    for (auto it = ourEntries.begin(); it != ourEntries.end(); ++it) names.insert(it->first);
+    for (auto it = theirEntries.begin(); it != theirEntries.end(); ++it) names.insert(it->first);
+
+    for (auto name = names.begin(); name != names.end(); ++name) {
+        TreeEntry base = baseEntries.count(*name) ? baseEntries[*name] : TreeEntry();
+        TreeEntry ours = ourEntries.count(*name) ? ourEntries[*name] : TreeEntry();
+        TreeEntry theirs = theirEntries.count(*name) ? theirEntries[*name] : TreeEntry();
+        string path = prefix + *name;
+
+        bool ourSame = ours.hash == base.hash && ours.mode == base.mode;
+        bool theirSame = theirs.hash == base.hash && theirs.mode == base.mode;
+
+        if ((ours.hash == theirs.hash && ours.mode == theirs.mode) || theirSame) {
+            continue;
+        }
+
+        if (ourSame) {
+            if (theirs.hash.empty()) {
+                merged.erase(*name);
+            } else {
+                merged[*name] = theirs;
+            }
+            continue;
+        }
+
+        bool baseIsTree = base.mode == DIRECTORY_MODE;
+        bool ourIsTree = ours.mode == DIRECTORY_MODE;
+        bool theirIsTree = theirs.mode == DIRECTORY_MODE;
+
+        if (ourIsTree && theirIsTree) {
+            string mergedSubtree = mergeTrees(baseIsTree ? base.hash : "", ours.hash, theirs.hash, path + "/",
+                                              theirsLabel, conflicts, writer);
+            merged[*name] = TreeEntry{DIRECTORY_MODE, *name, mergedSubtree};
+        } else if (!ours.hash.empty() && !theirs.hash.empty() && !ourIsTree && !theirIsTree) {
+            string mergedContent;
+            bool clean = mergeLines(baseIsTree ? "" : readBlob(base.hash), readBlob(ours.hash), readBlob(theirs.hash),
+                                    theirsLabel, mergedContent);
+
+            merged[*name] = TreeEntry{ours.mode, *name, writeObject(writer, "blob", mergedContent)};
+            if (!clean) {
+                conflicts.push_back(path);
+            }
+        } else {
+            //Modified on one side and deleted on the other, or a file on one side and a directory on the other.
+            //Our side is kept and the path is left for the user to resolve.
+            if (ours.hash.empty()) {
+                merged[*name] = theirs;
+            }
+            conflicts.push_back(path);
+        }
+    }
+
+    return writeObject(writer, "tree", serializeTree(merged));
+}
+
+
+
+
+//Checks that updating the working tree from headTree to newTree loses nothing. Every path that will be
+//rewritten or removed must still hold its HEAD content, and a path that HEAD does not track must be absent
+//or already hold the new content. Prints each path that would be overwritten.
+bool workingTreeMatches(const string& headTree, const string& newTree) {
+    vector<pair<string, string>> changes;
+    diffTrees(headTree, newTree, "", changes);
+
+    bool clean = true;
+    for (int i = 0; i < changes.size(); i++) {
+        const string& path = changes[i].first;
+
+        TreeEntry entry;
+        bool tracked = lookupPathEntryInTree(headTree, path, entry) && entry.mode != DIRECTORY_MODE;
+
+        error_code ec;
+        bool present = filesystem::exists(filesystem::symlink_status(path, ec));
+
+        string hash;
+        if (tracked) {
+            if (!present || (hashBlobFile(path, hash) && hash == entry.hash)) {
+                continue;
+            }
+        } else if (!present || (hashBlobFile(path, hash) && hash == changes[i].second)) {
+            continue;
+        }
+
+        cout << "Local changes to " << path << " would be overwritten by the merge." << endl;
+        clean = false;
+    }
+
+    return clean;
+}
+
+
+
+
+//Makes the working tree match newTree for every path that differs from oldTree.
+//Returns false if any file could not be written.
+bool updateWorkingTree(const string& oldTree, const string& newTree) {
+    vector<pair<string, string>> changes;
+    diffTrees(oldTree, newTree, "", changes);
+
+    //Removals go first so a file replaced by a directory (or the reverse) does not collide.
+    for (int i = 0; i < changes.size(); i++) {
+        if (changes[i].second.empty()) {
+            error_code ec;
+            filesystem::remove(changes[i].first, ec);
+        }
+    }
+
+    //The files are written through the object writer so their writes overlap, each renamed into place once complete.
+    ObjectWriter writer;
+    for (int i = 0; i < changes.size(); i++) {
+        if (changes[i].second.empty()) {
+            continue;
+        }
+
+        string content = readBlob(changes[i].second);
+        writer.submit(changes[i].first, vector<unsigned char>(content.begin(), content.end()));
+    }
+    writer.flush();
+
+    return writer.failures() == 0;
+}
+
+
+
+
+//Prints the merge base of two revisions.
+void printMergeBase(const string& one, const string& two) {
+    string commitOne = resolveRevision(one);
+    string commitTwo = resolveRevision(two);
+
+    if (commitOne.empty() || commitTwo.empty()) {
+        cout << "Unknown revision: " << (commitOne.empty() ? one : two) << endl;
+        exit(1);
+    }
+
+    CommitGraph graph;
+    string base = mergeBase(commitOne, commitTwo, graph);
+
+    if (base.empty()) {
+        cout << "No merge base found" << endl;
+        exit(1);
+    }
+
+    cout << base << endl;
+}
+
+
+
+
+//Merges a branch (or commit) into the current branch. Fast-forwards when possible, otherwise three-way merges
+//the trees and commits the result with both commits as parents. On conflicts the merged tree is written out
+//with conflict markers and recorded in MERGE_HEAD/MERGE_TREE so the next commit completes the merge, once
+//every path listed in MERGE_CONFLICTS has been added again. Local changes the merge would overwrite abort it.
+void merge(const string& branch) {
+    if (filesystem::exists(MERGE_HEAD_PATH)) {
+        cout << "A merge is already in progress. Resolve the conflicts, add the files and commit." << endl;
+        exit(1);
+    }
+
+    if (!collectAllIndexEntries().empty()) {
+        cout << "Commit staged changes before merging." << endl;
+        exit(1);
+    }
+
+    string ourCommit = resolveRevision("HEAD");
+    string theirCommit = resolveRevision(branch);
+
+    if (theirCommit.empty()) {
+        cout << "Unknown revision: " << branch << endl;
+        exit(1);
+    }
+
+    CommitInfo ours;
+    CommitInfo theirs;
+    if (!readCommit(theirCommit, theirs) || (!ourCommit.empty() && !readCommit(ourCommit, ours))) {
+        cout << "Failed to read commit objects" << endl;
+        exit(1);
+    }
+
+    CommitGraph graph;
+    string base = ourCommit.empty() ? "" : mergeBase(ourCommit, theirCommit, graph);
+
+    if (base == theirCommit) {
+        cout << "Already up to date." << endl;
+        return;
+    }
+
+    if (base == ourCommit) {
+        if (!workingTreeMatches(ours.tree, theirs.tree)) {
+            cout << "Commit or undo them before merging." << endl;
+            exit(1);
+        }
+
+        if (!updateWorkingTree(ours.tree, theirs.tree)) {
+            cout << "Failed writing the working tree; the branch was not moved." << endl;
+            exit(1);
+        }
+
+        ifstream headFile(".mygit/HEAD");
+        if (!updateRef(".mygit/" + parseHeadForBranch(headFile), theirCommit)) {
+            cout << "Failed to update branch heads file" << endl;
+            exit(1);
+        }
+
+        cout << "Fast-forward to " << theirCommit << endl;
+        return;
+    }
+
+    CommitInfo baseCommit;
+    if (!base.empty() && !readCommit(base, baseCommit)) {
+        cout << "Failed to read merge base " << base << endl;
+        exit(1);
+    }
+
+    vector<string> conflicts;
+    ObjectWriter writer;
+    string mergedTree = mergeTrees(baseCommit.tree, ours.tree, theirs.tree, "", branch, conflicts, writer);
+    writer.flush();
+
+    if (writer.failures() > 0) {
+        cout << "Failed writing " << writer.failures() << " merged objects." << endl;
+        exit(1);
+    }
+
+    if (!workingTreeMatches(ours.tree, mergedTree)) {
+        cout << "Commit or undo them before merging." << endl;
+        exit(1);
+    }
+
+    if (!updateWorkingTree(ours.tree, mergedTree)) {
+        cout << "Failed writing the working tree; the merge was not committed." << endl;
+        exit(1);
+    }
+
+    if (conflicts.empty()) {
+        string message = "Merge branch '" + branch + "'";
+        buildCommitObject(mergedTree, {ourCommit, theirCommit}, message);
+        return;
+    }
+
+    ofstream mergeHead(MERGE_HEAD_PATH);
+    mergeHead << theirCommit;
+    mergeHead.close();
+
+    ofstream mergeTree(MERGE_TREE_PATH);
+    mergeTree << mergedTree;
+    mergeTree.close();
+
+    ofstream mergeConflicts(MERGE_CONFLICTS_PATH);
+    for (int i = 0; i < conflicts.size(); i++) {
+        mergeConflicts << conflicts[i] << "\n";
+    }
+    mergeConflicts.close();
+
+    for (int i = 0; i < conflicts.size(); i++) {
+        cout << "CONFLICT: " << conflicts[i] << endl;
+    }
+    cout << "Automatic merge failed. Fix the conflicts, add the files and commit." << endl;
+}
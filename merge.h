@@ -0,0 +1,40 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef MERGE_H
+#define MERGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <filesystem>
+#include <unordered_map>
+
+#include "util.h"
+#include "commit.h"
+#include "commitGraph.h"
+#include "tree.h"
+#include "objectWriter.h"
+
+using namespace std;
+
+//Files whose middle section (after trimming common lines) needs a larger table than this are not line-merged.
+constexpr size_t MAX_LINE_MERGE_CELLS = 10000000;
+
+
+string mergeBase(const string&, const string&, CommitGraph&);
+vector<string> splitLines(const string&);
+vector<int> matchLines(const vector<string>&, const vector<string>&);
+string readBlob(const string&);
+bool mergeLines(const string&, const string&, const string&, const string&, string&);
+string mergeTrees(const string&, const string&, const string&, const string&, const string&,
+                  vector<string>&, ObjectWriter&);
+bool workingTreeMatches(const string&, const string&);
+bool updateWorkingTree(const string&, const string&);
+void printMergeBase(const string&, const string&);
+void merge(const string&);
+
+
+#endif //MERGE_H
@@ -0,0 +1,44 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "objectCache.h"
+
+
+ObjectCache::ObjectCache(size_t maxBytes) : maxBytes(maxBytes) {
+}
+
+
+
+
+//Reads an object through the cache. Returns false if the object does not exist or is malformed.
+bool ObjectCache::read(const string& hash, string& type, string& content) {
+    auto cached = index.find(hash);
+    if (cached != index.end()) {
+        //Move to the front so it is evicted last.
+        objects.splice(objects.begin(), objects, cached->second);
+        type = cached->second->type;
+        content = cached->second->content;
+        return true;
+    }
+
+    if (!readObject(hash, type, content)) {
+        return false;
+    }
+
+    if (content.size() > maxBytes) {
+        return true;
+    }
+
+    objects.push_front(CachedObject{hash, type, content});
+    index[hash] = objects.begin();
+    usedBytes += content.size();
+
+    while (usedBytes > maxBytes) {
+        usedBytes -= objects.back().content.size();
+        index.erase(objects.back().hash);
+        objects.pop_back();
+    }
+
+    return true;
+}
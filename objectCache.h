@@ -0,0 +1,41 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef OBJECTCACHE_H
+#define OBJECTCACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+
+#include "util.h"
+
+using namespace std;
+
+constexpr size_t DEFAULT_OBJECT_CACHE_BYTES = 64 * 1024 * 1024;
+
+struct CachedObject {
+    string hash;
+    string type;
+    string content;
+};
+
+
+//Keeps recently read objects decompressed in memory, evicting the least recently used once the contents
+//exceed maxBytes. Objects larger than the whole cache are returned but not kept.
+class ObjectCache {
+public:
+    explicit ObjectCache(size_t maxBytes = DEFAULT_OBJECT_CACHE_BYTES);
+
+    bool read(const string&, string&, string&);
+
+private:
+    list<CachedObject> objects;
+    unordered_map<string, list<CachedObject>::iterator> index;
+    size_t maxBytes;
+    size_t usedBytes = 0;
+};
+
+
+#endif //OBJECTCACHE_H
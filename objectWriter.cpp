@@ -0,0 +1,532 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "objectWriter.h"
+
+
+IoUring::~IoUring() {
+    if (sqeMemory != MAP_FAILED) {
+        munmap(sqeMemory, sqeMemorySize);
+    }
+    if (cqRing != MAP_FAILED && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing != MAP_FAILED) {
+        munmap(sqRing, sqRingSize);
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+    }
+}
+
+
+
+
+//Creates a ring with room for at least entries submissions and maps its queues. Returns false if the
+//kernel has no io_uring or refuses to create one, in which case the caller should use something else.
+bool IoUring::setup(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+    ringFd = fd;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    //Newer kernels map both queues with one call.
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap) {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+    }
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        return false;
+    }
+
+    cqRing = singleMap ? sqRing :
+             mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED) {
+        return false;
+    }
+
+    sqeMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMemory = mmap(nullptr, sqeMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMemory == MAP_FAILED) {
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sqRing);
+    char* cq = static_cast<char*>(cqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+    sqEntries = params.sq_entries;
+    localTail = *sqTail;
+    return true;
+}
+
+
+
+
+//Returns true if the kernel implements every one of the given operations. Older kernels have io_uring
+//but not the open, close or rename operations.
+bool IoUring::supports(const vector<int>& operations) {
+    constexpr unsigned probeSize = 256;
+    vector<unsigned char> buffer(sizeof(io_uring_probe) + probeSize * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, probeSize) < 0) {
+        return false;
+    }
+
+    for (int i = 0; i < operations.size(); i++) {
+        if (operations[i] > probe->last_op || !(probe->ops[operations[i]].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+unsigned IoUring::entries() const {
+    return sqEntries;
+}
+
+
+
+
+//Returns a cleared submission entry to fill in, or nullptr if the submission queue is full.
+//Entries become visible to the kernel on the next submit().
+io_uring_sqe* IoUring::nextSqe() {
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (localTail - head >= sqEntries) {
+        return nullptr;
+    }
+
+    unsigned index = localTail & *sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray[index] = index;
+
+    localTail++;
+    unsubmitted++;
+    return sqe;
+}
+
+
+
+
+//Hands every prepared entry to the kernel and waits until at least waitFor completions are ready.
+//Returns false if the ring can no longer be used.
+bool IoUring::submit(unsigned waitFor) {
+    __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+
+    while (true) {
+        long result = syscall(__NR_io_uring_enter, ringFd, unsubmitted, waitFor,
+                              waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (result >= 0) {
+            unsubmitted -= result;
+            return true;
+        }
+
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+
+
+
+//Takes the oldest completion off the queue. Returns false if there is none.
+bool IoUring::nextCompletion(io_uring_cqe& completion) {
+    unsigned head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    completion = cqes[head & *cqMask];
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+
+
+//Starts the thread that drives the ring, or, where io_uring (or one of the operations a write needs) is
+//missing, the I/O threads. Object writes spend most of their time waiting on the filesystem, so there are
+//more I/O threads than cores.
+ObjectWriter::ObjectWriter(size_t maxInFlight) : maxInFlight(maxInFlight == 0 ? 1 : maxInFlight) {
+    unsigned ringEntries = min<size_t>(OBJECT_RING_ENTRIES, this->maxInFlight);
+
+    if (getenv(DISABLE_IO_URING_VARIABLE) == nullptr && ring.setup(ringEntries) &&
+        ring.supports({IORING_OP_OPENAT, IORING_OP_WRITE, IORING_OP_CLOSE, IORING_OP_RENAMEAT})) {
+        ringSlots.resize(min<size_t>(ring.entries(), this->maxInFlight));
+        workers.emplace_back(&ObjectWriter::ringLoop, this);
+        return;
+    }
+
+    size_t threadCount = max<size_t>(4, thread::hardware_concurrency() * 4);
+    threadCount = min(threadCount, this->maxInFlight);
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ObjectWriter::workerLoop, this);
+    }
+}
+
+
+
+
+//Waits for every submitted write to finish and stops the I/O threads.
+ObjectWriter::~ObjectWriter() {
+    flush();
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+
+
+
+//Queues data to be written to the file at path. Blocks while maxInFlight writes are already pending.
+void ObjectWriter::submit(const string& path, vector<unsigned char> data) {
+    unique_lock<mutex> lock(queueMutex);
+    spaceAvailable.wait(lock, [this] { return inFlight < maxInFlight; });
+
+    inFlight++;
+    queue.push_back(PendingWrite{path, move(data)});
+    lock.unlock();
+
+    workAvailable.notify_one();
+}
+
+
+
+
+//Blocks until every write submitted so far has completed.
+void ObjectWriter::flush() {
+    unique_lock<mutex> lock(queueMutex);
+    drained.wait(lock, [this] { return inFlight == 0; });
+}
+
+
+
+
+//Returns the number of writes that failed.
+int ObjectWriter::failures() const {
+    return failed.load();
+}
+
+
+
+
+void ObjectWriter::workerLoop() {
+    while (true) {
+        unique_lock<mutex> lock(queueMutex);
+        workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+
+        if (queue.empty()) {
+            return;
+        }
+
+        PendingWrite write = move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+
+        finishWrite(writeOne(write));
+    }
+}
+
+
+
+
+//Counts a write as done, waking a blocked submit() and, once nothing is left, flush().
+void ObjectWriter::finishWrite(bool succeeded) {
+    if (!succeeded) {
+        failed++;
+    }
+
+    unique_lock<mutex> lock(queueMutex);
+    inFlight--;
+    bool isDrained = inFlight == 0;
+    lock.unlock();
+
+    spaceAvailable.notify_one();
+    if (isDrained) {
+        drained.notify_all();
+    }
+}
+
+
+
+
+//Keeps every slot of the ring busy with a queued write. Each completion moves its write on to the next
+//operation, and all the operations prepared in one pass go to the kernel with a single system call.
+void ObjectWriter::ringLoop() {
+    vector<uint64_t> freeSlots;
+    for (uint64_t slot = ringSlots.size(); slot > 0; slot--) {
+        freeSlots.push_back(slot - 1);
+    }
+    vector<char> busy(ringSlots.size(), 0);
+    size_t active = 0;
+
+    while (true) {
+        vector<uint64_t> started;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            if (active == 0) {
+                workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+
+                if (queue.empty()) {
+                    return;
+                }
+            }
+
+            while (!queue.empty() && !freeSlots.empty()) {
+                uint64_t slot = freeSlots.back();
+                freeSlots.pop_back();
+
+                ringSlots[slot].write = move(queue.front());
+                queue.pop_front();
+                started.push_back(slot);
+            }
+        }
+
+        for (int i = 0; i < started.size(); i++) {
+            startRingWrite(ringSlots[started[i]], started[i]);
+            busy[started[i]] = 1;
+            active++;
+        }
+
+        //If the ring stops working, the writes on it are lost and the rest are written on this thread.
+        if (!ring.submit(1)) {
+            for (uint64_t slot = 0; slot < ringSlots.size(); slot++) {
+                if (busy[slot]) {
+                    cout << "Failed writing file " << ringSlots[slot].tempPath << endl;
+                    if (ringSlots[slot].fd >= 0) {
+                        close(ringSlots[slot].fd);
+                    }
+                    error_code ec;
+                    filesystem::remove(ringSlots[slot].tempPath, ec);
+                    finishWrite(false);
+                }
+            }
+
+            workerLoop();
+            return;
+        }
+
+        io_uring_cqe completion;
+        while (ring.nextCompletion(completion)) {
+            uint64_t slot = completion.user_data;
+
+            if (advanceRingWrite(ringSlots[slot], slot, completion.res)) {
+                finishWrite(!ringSlots[slot].failed);
+
+                ringSlots[slot] = RingWrite();
+                busy[slot] = 0;
+                freeSlots.push_back(slot);
+                active--;
+            }
+        }
+    }
+}
+
+
+
+
+//Creates the destination directory and queues the open of a temporary file beside the destination.
+//The pid and a counter keep temporary names unique across writers and processes.
+void ObjectWriter::startRingWrite(RingWrite& write, uint64_t slot) {
+    string directory = filesystem::path(write.write.path).parent_path().string();
+    if (!directory.empty() && createdDirectories.insert(directory).second) {
+        error_code ec;
+        filesystem::create_directories(directory, ec);
+    }
+
+    write.tempPath = write.write.path + ".tmp" + to_string(getpid()) + "-" + to_string(++tempCounter);
+    write.stage = RingStage::OPEN;
+    queueRingStage(write, slot);
+}
+
+
+
+
+//Handles the result of a write's current operation and queues its next one. Returns true once the write
+//is finished, successfully or not; a failed write still closes and removes its temporary file.
+bool ObjectWriter::advanceRingWrite(RingWrite& write, uint64_t slot, int result) {
+    error_code ec;
+
+    switch (write.stage) {
+        case RingStage::OPEN:
+            if (result < 0) {
+                cout << "Failed creating file " << write.tempPath << endl;
+                write.failed = true;
+                return true;
+            }
+            write.fd = result;
+            write.stage = RingStage::WRITE;
+            break;
+
+        case RingStage::WRITE:
+            if (result <= 0) {
+                cout << "Failed writing file " << write.tempPath << endl;
+                write.failed = true;
+                write.stage = RingStage::CLOSE;
+            } else {
+                write.written += result;
+            }
+            break;
+
+        case RingStage::CLOSE:
+            write.fd = -1;
+            if (result < 0 && !write.failed) {
+                cout << "Failed writing file " << write.tempPath << endl;
+                write.failed = true;
+            }
+
+            if (write.failed) {
+                filesystem::remove(write.tempPath, ec);
+                return true;
+            }
+            write.stage = RingStage::RENAME;
+            break;
+
+        case RingStage::RENAME:
+            if (result < 0) {
+                cout << "Failed renaming " << write.tempPath << " to " << write.write.path << endl;
+                write.failed = true;
+                filesystem::remove(write.tempPath, ec);
+            }
+            return true;
+    }
+
+    //Short writes are continued from where they stopped.
+    if (write.stage == RingStage::WRITE && write.written == write.write.data.size()) {
+        write.stage = RingStage::CLOSE;
+    }
+
+    queueRingStage(write, slot);
+    return false;
+}
+
+
+
+
+void ObjectWriter::queueRingStage(RingWrite& write, uint64_t slot) {
+    io_uring_sqe* sqe;
+    while ((sqe = ring.nextSqe()) == nullptr) {
+        ring.submit(0);
+    }
+
+    switch (write.stage) {
+        case RingStage::OPEN:
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(write.tempPath.c_str());
+            sqe->len = 0666;
+            sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+            break;
+
+        case RingStage::WRITE:
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = write.fd;
+            sqe->addr = reinterpret_cast<uint64_t>(write.write.data.data() + write.written);
+            sqe->len = min(write.write.data.size() - write.written, RING_MAX_WRITE);
+            sqe->off = write.written;
+            break;
+
+        case RingStage::CLOSE:
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = write.fd;
+            break;
+
+        case RingStage::RENAME:
+            sqe->opcode = IORING_OP_RENAMEAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(write.tempPath.c_str());
+            sqe->len = AT_FDCWD;
+            sqe->off = reinterpret_cast<uint64_t>(write.write.path.c_str());
+            break;
+    }
+
+    sqe->user_data = slot;
+}
+
+
+
+
+//Writes one file to a temporary name next to its destination, then renames it into place.
+bool ObjectWriter::writeOne(PendingWrite& write) {
+    filesystem::path destination(write.path);
+    error_code ec;
+
+    filesystem::create_directories(destination.parent_path(), ec);
+
+    //Thread id keeps temp names unique when two threads write the same object.
+    string tempPath = write.path + ".tmp" + to_string(hash<thread::id>{}(this_thread::get_id()));
+
+    ofstream file(tempPath, ios::binary);
+    if (!file.is_open()) {
+        cout << "Failed creating file " << tempPath << endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(write.data.data()), write.data.size());
+    file.close();
+
+    if (!file) {
+        cout << "Failed writing file " << tempPath << endl;
+        filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    filesystem::rename(tempPath, destination, ec);
+    if (ec) {
+        cout << "Failed renaming " << tempPath << " to " << write.path << endl;
+        filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+//Builds the object for content of the given type, compresses it and queues it on the writer
+//unless it is already in the object store. Returns the hash of the object.
+string writeObject(ObjectWriter& writer, const string& type, const string& content) {
+    string object = type + " " + to_string(content.size()) + '\0' + content;
+    string hashedObject = sha256(object);
+    string path = objectPath(hashedObject);
+
+    if (!filesystem::exists(path)) {
+        writer.submit(path, compressUsingDeflate(reinterpret_cast<const unsigned char*>(object.data()), object.size()));
+    }
+
+    return hashedObject;
+}
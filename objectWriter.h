@@ -0,0 +1,137 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef OBJECTWRITER_H
+#define OBJECTWRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <unordered_set>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "util.h"
+
+using namespace std;
+
+constexpr size_t DEFAULT_WRITES_IN_FLIGHT = 256;
+constexpr unsigned OBJECT_RING_ENTRIES = 256;
+//A single write request is capped below the 32-bit length an io_uring write takes.
+constexpr size_t RING_MAX_WRITE = 1 << 30;
+//Set to write with the thread pool even where io_uring is available.
+const char* const DISABLE_IO_URING_VARIABLE = "MYGIT_NO_IO_URING";
+
+struct PendingWrite {
+    string path;
+    vector<unsigned char> data;
+};
+
+
+//A minimal io_uring driven through the raw system calls, so no extra library is needed.
+//Only one thread may prepare, submit and reap at a time.
+class IoUring {
+public:
+    ~IoUring();
+
+    bool setup(unsigned);
+    bool supports(const vector<int>&);
+    unsigned entries() const;
+    io_uring_sqe* nextSqe();
+    bool submit(unsigned);
+    bool nextCompletion(io_uring_cqe&);
+
+private:
+    int ringFd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    void* sqeMemory = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqeMemorySize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    io_uring_sqe* sqes = nullptr;
+
+    unsigned sqEntries = 0;
+    unsigned localTail = 0;
+    unsigned unsubmitted = 0;
+};
+
+
+enum class RingStage { OPEN, WRITE, CLOSE, RENAME };
+
+//One write moving through the ring: open the temporary file, write it in pieces, close it, rename it.
+struct RingWrite {
+    PendingWrite write;
+    string tempPath;
+    int fd = -1;
+    size_t written = 0;
+    RingStage stage = RingStage::OPEN;
+    bool failed = false;
+};
+
+
+//Batches object file writes so that the open/write/close/rename latency of many objects overlaps instead
+//of being paid one after another. Where the kernel supports it, one thread keeps up to maxInFlight writes
+//queued on an io_uring; otherwise a pool of I/O threads writes them, and only as many overlap as there are threads.
+//Every file is written to a temporary name and renamed into place so readers never see a partial object.
+class ObjectWriter {
+public:
+    explicit ObjectWriter(size_t maxInFlight = DEFAULT_WRITES_IN_FLIGHT);
+    ~ObjectWriter();
+
+    void submit(const string&, vector<unsigned char>);
+    void flush();
+    int failures() const;
+
+private:
+    void workerLoop();
+    bool writeOne(PendingWrite&);
+    void ringLoop();
+    void startRingWrite(RingWrite&, uint64_t);
+    bool advanceRingWrite(RingWrite&, uint64_t, int);
+    void queueRingStage(RingWrite&, uint64_t);
+    void finishWrite(bool);
+
+    deque<PendingWrite> queue;
+    vector<thread> workers;
+    mutex queueMutex;
+    condition_variable workAvailable;
+    condition_variable spaceAvailable;
+    condition_variable drained;
+    size_t maxInFlight;
+    size_t inFlight = 0;
+    bool stopping = false;
+    atomic<int> failed{0};
+
+    IoUring ring;
+    vector<RingWrite> ringSlots;
+    unordered_set<string> createdDirectories;
+    unsigned long long tempCounter = 0;
+};
+
+
+
+string writeObject(ObjectWriter&, const string&, const string&);
+
+
+#endif //OBJECTWRITER_H
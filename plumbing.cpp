@@ -0,0 +1,169 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "plumbing.h"
+
+
+//Resolves an object name. Full hashes are used as-is without touching the disk, anything else
+//goes through resolveRevision. Returns an empty string if the name is not valid.
+string resolveObject(const string& name) {
+    if (name.size() == 2 * SHA256_DIGEST_LENGTH && name.find_first_not_of("0123456789abcdef") == string::npos) {
+        return name;
+    }
+
+    return resolveRevision(name);
+}
+
+
+
+
+//Formats tree entries as "<mode> <type> <hash>\t<path>" lines. Recursive listing descends into subtrees
+//and prints the blobs in them with their full paths.
+string formatTreeEntries(const vector<TreeEntry>& entries, const string& prefix, bool recursive) {
+    string result;
+
+    for (int i = 0; i < entries.size(); i++) {
+        bool isTree = entries[i].mode == DIRECTORY_MODE;
+
+        if (isTree && recursive) {
+            result += formatTreeEntries(readTree(entries[i].hash), prefix + entries[i].name + "/", true);
+            continue;
+        }
+
+        result += entries[i].mode + " " + (isTree ? "tree" : "blob") + " " + entries[i].hash + "\t" +
+                  prefix + entries[i].name + "\n";
+    }
+
+    return result;
+}
+
+
+
+
+//Prints information about one object: its type (-t), its size (-s) or its contents (-p).
+void catFile(const string& option, const string& name) {
+    string hash = resolveObject(name);
+    string type;
+    string content;
+
+    if (hash.empty() || !readObject(hash, type, content)) {
+        cout << "Not a valid object name " << name << endl;
+        exit(1);
+    }
+
+    if (option == "-t") {
+        cout << type << endl;
+    } else if (option == "-s") {
+        cout << content.size() << endl;
+    } else if (option == "-p") {
+        if (type == "tree") {
+            cout << formatTreeEntries(parseTree(content), "", false);
+        } else {
+            cout << content;
+        }
+    } else {
+        cout << "Usage: ./mygit cat-file (-t | -s | -p) [object]" << endl;
+        exit(1);
+    }
+}
+
+
+
+
+//Long-lived bulk reader. Reads one object name per line from stdin and writes "<hash> <type> <size>" followed by
+//the contents (or only the header with --batch-check) to stdout. Output is collected in one buffer and only
+//written when it is full or when no more input is waiting, so piped requests stream through in large writes
+//while an interactive caller still gets each answer before it sends the next name.
+void catFileBatch(bool contents) {
+    signal(SIGPIPE, SIG_IGN);
+    ios::sync_with_stdio(false);
+
+    ObjectCache cache;
+    string buffer;
+    string line;
+    string type;
+    string content;
+
+    auto flushBuffer = [&]() {
+        if (fwrite(buffer.data(), 1, buffer.size(), stdout) != buffer.size() || fflush(stdout) != 0) {
+            return false;
+        }
+        buffer.clear();
+        return true;
+    };
+
+    while (getline(cin, line)) {
+        string hash = resolveObject(line);
+
+        if (hash.empty() || !cache.read(hash, type, content)) {
+            buffer += line + " missing\n";
+        } else {
+            buffer += hash + " " + type + " " + to_string(content.size()) + "\n";
+            if (contents) {
+                buffer += content;
+                buffer += '\n';
+            }
+        }
+
+        if ((buffer.size() >= BATCH_BUFFER_SIZE || cin.rdbuf()->in_avail() <= 0) && !flushBuffer()) {
+            return;
+        }
+    }
+
+    flushBuffer();
+}
+
+
+
+
+//Lists the entries of a tree, or of the tree of a commit.
+void lsTree(const string& name, bool recursive) {
+    string hash = resolveObject(name);
+    string type;
+    string content;
+
+    if (hash.empty() || !readObject(hash, type, content)) {
+        cout << "Not a valid object name " << name << endl;
+        exit(1);
+    }
+
+    if (type == "commit") {
+        hash = parseCommit(hash, content).tree;
+        if (!readObject(hash, type, content)) {
+            cout << "Failed to read tree " << hash << endl;
+            exit(1);
+        }
+    }
+
+    if (type != "tree") {
+        cout << "Not a tree object " << name << endl;
+        exit(1);
+    }
+
+    cout << formatTreeEntries(parseTree(content), "", recursive);
+}
+
+
+
+
+//Prints the hash a file would have as a blob, and writes the blob to the object store with -w.
+void hashObject(const string& file, bool write) {
+    string fileContents = readFile(file);
+
+    if (write) {
+        ObjectWriter writer(1);
+        string hash = writeObject(writer, "blob", fileContents);
+        writer.flush();
+
+        if (writer.failures() > 0) {
+            cout << "Failed writing object " << hash << endl;
+            exit(1);
+        }
+
+        cout << hash << endl;
+        return;
+    }
+
+    cout << sha256("blob " + to_string(fileContents.size()) + '\0' + fileContents) << endl;
+}
@@ -0,0 +1,33 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef PLUMBING_H
+#define PLUMBING_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <csignal>
+#include <iostream>
+
+#include "util.h"
+#include "tree.h"
+#include "commit.h"
+#include "objectCache.h"
+#include "objectWriter.h"
+
+using namespace std;
+
+constexpr size_t BATCH_BUFFER_SIZE = 65536;
+
+
+string resolveObject(const string&);
+string formatTreeEntries(const vector<TreeEntry>&, const string&, bool);
+void catFile(const string&, const string&);
+void catFileBatch(bool);
+void lsTree(const string&, bool);
+void hashObject(const string&, bool);
+
+
+#endif //PLUMBING_H
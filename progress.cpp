@@ -0,0 +1,66 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "progress.h"
+
+
+Progress::Progress(const string& title, size_t total) : title(title), total(total) {
+    enabled = isatty(STDERR_FILENO);
+    start = chrono::steady_clock::now();
+    lastPrint = start;
+}
+
+
+
+
+//Records that done units are complete, printing at most every PROGRESS_INTERVAL_SECONDS.
+void Progress::update(size_t done) {
+    this->done = done;
+
+    if (!enabled) {
+        return;
+    }
+
+    auto now = chrono::steady_clock::now();
+    double sinceStart = chrono::duration<double>(now - start).count();
+    double sincePrint = chrono::duration<double>(now - lastPrint).count();
+
+    if (sinceStart >= PROGRESS_DELAY_SECONDS && (!shown || sincePrint >= PROGRESS_INTERVAL_SECONDS)) {
+        print(false);
+        lastPrint = now;
+    }
+}
+
+
+
+
+//Prints the final line if progress was shown at all.
+void Progress::finish() {
+    if (enabled && shown) {
+        print(true);
+    }
+}
+
+
+
+
+void Progress::print(bool last) {
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double rate = elapsed > 0 ? done / elapsed : 0;
+
+    if (total > 0) {
+        int percent = done * 100 / total;
+        fprintf(stderr, "\r%s: %3d%% (%zu/%zu), %.0f/s", title.c_str(), percent, done, total, rate);
+
+        if (!last && rate > 0 && done < total) {
+            fprintf(stderr, ", ETA %.0fs", (total - done) / rate);
+        }
+    } else {
+        fprintf(stderr, "\r%s: %zu, %.0f/s", title.c_str(), done, rate);
+    }
+
+    fprintf(stderr, last ? ", done.\n" : "   ");
+    fflush(stderr);
+    shown = true;
+}
@@ -0,0 +1,42 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace std;
+
+//Progress is only shown for operations still running after this long.
+constexpr double PROGRESS_DELAY_SECONDS = 1.0;
+constexpr double PROGRESS_INTERVAL_SECONDS = 0.5;
+
+
+//Reports how far a long operation has got, with its rate and an estimate of the time left, on one
+//line of stderr. Nothing is printed when stderr is not a terminal or the operation finishes quickly.
+class Progress {
+public:
+    Progress(const string&, size_t);
+
+    void update(size_t);
+    void finish();
+
+private:
+    void print(bool);
+
+    string title;
+    size_t total;
+    size_t done = 0;
+    bool enabled;
+    bool shown = false;
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point lastPrint;
+};
+
+
+#endif //PROGRESS_H
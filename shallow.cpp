@@ -0,0 +1,140 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "shallow.h"
+
+
+//Adds a tree and everything below it to reachable. Subtrees already seen are not read again.
+void collectReachableTree(const string& treeHash, unordered_set<string>& reachable) {
+    if (!reachable.insert(treeHash).second) {
+        return;
+    }
+
+    vector<TreeEntry> entries = readTree(treeHash);
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].mode == DIRECTORY_MODE) {
+            collectReachableTree(entries[i].hash, reachable);
+        } else {
+            reachable.insert(entries[i].hash);
+        }
+    }
+}
+
+
+
+
+//Collects every object reachable from the branches, an in-progress merge, the index and the commit journal,
+//stopping at shallow commits.
+unordered_set<string> collectReachableObjects() {
+    unordered_set<string> reachable;
+    vector<string> commits;
+
+    for (auto& ref : filesystem::directory_iterator(".mygit/refs/heads")) {
+        string hash = readRef(ref.path().string());
+        if (!hash.empty()) {
+            commits.push_back(hash);
+        }
+    }
+
+    if (filesystem::exists(MERGE_HEAD_PATH)) {
+        commits.push_back(readRef(MERGE_HEAD_PATH));
+        collectReachableTree(readRef(MERGE_TREE_PATH), reachable);
+    }
+
+    //Staged blobs and the trees of an interrupted commit are not referenced by any commit yet.
+    ifstream indexFile(".mygit/index");
+    vector<IndexEntry> staged = parseIndexEntries(indexFile);
+    for (int i = 0; i < staged.size(); i++) {
+        reachable.insert(staged[i].hashString);
+    }
+
+    ifstream journalFile(COMMIT_JOURNAL_PATH);
+    string line;
+    getline(journalFile, line);
+    while (getline(journalFile, line)) {
+        if (line.size() > 2 * SHA256_DIGEST_LENGTH) {
+            collectReachableTree(line.substr(0, 2 * SHA256_DIGEST_LENGTH), reachable);
+        }
+    }
+
+    while (!commits.empty()) {
+        string hash = commits.back();
+        commits.pop_back();
+
+        CommitInfo commit;
+        if (!reachable.insert(hash).second || !readCommit(hash, commit)) {
+            continue;
+        }
+
+        collectReachableTree(commit.tree, reachable);
+        commits.insert(commits.end(), commit.parents.begin(), commit.parents.end());
+    }
+
+    return reachable;
+}
+
+
+
+
+//Deletes every loose object that is no longer reachable. The commit-graph is dropped too, since it lists
+//deleted commits; it is rebuilt from the remaining history the next time it is needed.
+void pruneUnreachableObjects() {
+    unordered_set<string> reachable = collectReachableObjects();
+    int removed = 0;
+
+    for (auto& folder : filesystem::directory_iterator(".mygit/objects")) {
+        if (!folder.is_directory()) {
+            continue;
+        }
+
+        for (auto& object : filesystem::directory_iterator(folder.path())) {
+            string hash = folder.path().filename().string() + object.path().filename().string();
+
+            if (reachable.count(hash) == 0) {
+                filesystem::remove(object.path());
+                removed++;
+            }
+        }
+    }
+
+    error_code ec;
+    filesystem::remove(COMMIT_GRAPH_PATH, ec);
+
+    cout << "Removed " << removed << " unreachable objects." << endl;
+}
+
+
+
+
+//Marks a commit as shallow, so the history below it is treated as absent. With prune, the objects only
+//reachable through that history are deleted from the object store.
+void shallow(const string& revision, bool prune) {
+    string hash = resolveRevision(revision);
+
+    CommitInfo commit;
+    if (hash.empty() || !readCommit(hash, commit)) {
+        cout << "Unknown revision: " << revision << endl;
+        exit(1);
+    }
+
+    if (shallowCommits().count(hash) == 0) {
+        ofstream shallowFile(SHALLOW_PATH, ios::app);
+        if (!shallowFile.is_open()) {
+            cout << "Failed to open shallow file" << endl;
+            exit(1);
+        }
+
+        shallowFile << hash << "\n";
+        shallowFile.close();
+
+        //Later reads in this process must see the new marker as well.
+        shallowCommits().insert(hash);
+    }
+
+    cout << "History below " << hash << " is now shallow." << endl;
+
+    if (prune) {
+        pruneUnreachableObjects();
+    }
+}
@@ -0,0 +1,28 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef SHALLOW_H
+#define SHALLOW_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <unordered_set>
+
+#include "util.h"
+#include "commit.h"
+#include "commitGraph.h"
+#include "tree.h"
+
+using namespace std;
+
+
+void collectReachableTree(const string&, unordered_set<string>&);
+unordered_set<string> collectReachableObjects();
+void pruneUnreachableObjects();
+void shallow(const string&, bool);
+
+
+#endif //SHALLOW_H
@@ -0,0 +1,318 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "status.h"
+
+
+//Adds the path of every blob in a tree, each prefixed with prefix.
+void collectTreePaths(const string& treeHash, const string& prefix, set<string>& paths) {
+    if (treeHash.empty()) {
+        return;
+    }
+
+    vector<TreeEntry> entries = readTree(treeHash);
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].mode == DIRECTORY_MODE) {
+            collectTreePaths(entries[i].hash, prefix + entries[i].name + "/", paths);
+        } else {
+            paths.insert(prefix + entries[i].name);
+        }
+    }
+}
+
+
+
+
+//Adds path if it names a file (or nothing, so a deletion is still checked), or every file below it that
+//is not ignored if it names a directory. An empty path is the whole working tree.
+void collectWorkingPaths(const string& path, set<string>& paths, IgnoreMatcher& ignoreMatcher) {
+    string directory = path.empty() ? "." : path;
+    error_code ec;
+
+    if (!filesystem::is_directory(filesystem::symlink_status(directory, ec))) {
+        paths.insert(path);
+        return;
+    }
+
+    if (!path.empty() && isPathIgnored(path + "/", ignoreMatcher)) {
+        return;
+    }
+
+    for (filesystem::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        string entryPath = it->path().lexically_normal().generic_string();
+        bool isDirectory = it->is_directory(ec);
+
+        if (ignoreMatcher.isIgnored(entryPath, isDirectory)) {
+            if (isDirectory) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+
+        if (it->is_regular_file(ec)) {
+            paths.insert(entryPath);
+        }
+    }
+}
+
+
+
+
+//Checks a path and every directory above it against the ignore rules, since a path reported by the
+//monitor was not reached by a walk that would have pruned its ignored parents. A trailing slash marks a directory.
+bool isPathIgnored(const string& path, IgnoreMatcher& ignoreMatcher) {
+    for (size_t slash = path.find('/'); slash != string::npos; slash = path.find('/', slash + 1)) {
+        if (ignoreMatcher.isIgnored(path.substr(0, slash), true)) {
+            return true;
+        }
+    }
+
+    return path.back() != '/' && ignoreMatcher.isIgnored(path, false);
+}
+
+
+
+
+bool loadStatusCache(StatusCache& cache) {
+    ifstream cacheFile(STATUS_CACHE_PATH);
+    if (!cacheFile.is_open()) {
+        return false;
+    }
+
+    string tokenLine;
+    string treeLine;
+    if (!getline(cacheFile, tokenLine) || tokenLine.compare(0, 6, "token ") != 0 ||
+        !getline(cacheFile, treeLine) || treeLine.compare(0, 5, "tree ") != 0) {
+        return false;
+    }
+
+    cache.token = tokenLine.substr(6);
+    cache.headTree = treeLine.substr(5);
+
+    string path;
+    while (getline(cacheFile, path)) {
+        if (!path.empty()) {
+            cache.paths.push_back(path);
+        }
+    }
+
+    return true;
+}
+
+
+
+
+//Writes the cache to a temporary file first, so a reader never sees a token without its paths.
+void saveStatusCache(const StatusCache& cache) {
+    string temporaryPath = STATUS_CACHE_PATH + ".tmp";
+    ofstream cacheFile(temporaryPath, ios::trunc);
+    if (!cacheFile.is_open()) {
+        return;
+    }
+
+    string contents = "token " + cache.token + "\ntree " + cache.headTree + "\n";
+    for (int i = 0; i < cache.paths.size(); i++) {
+        contents += cache.paths[i] + "\n";
+    }
+    cacheFile << contents;
+    cacheFile.close();
+
+    error_code ec;
+    filesystem::rename(temporaryPath, STATUS_CACHE_PATH, ec);
+}
+
+
+
+
+//Compares the working tree with the index and the HEAD tree. With a valid fsmonitor token only the paths
+//reported since the last scan, the paths that were not clean then or lie in ignored directories, the staged
+//paths, and the paths HEAD has changed since are examined. Otherwise every tracked and untracked file is,
+//unless allowFullScan is false, in which case nothing is examined and false is returned.
+bool scanWorkingTree(WorkingTreeStatus& result, bool allowFullScan) {
+    if (!filesystem::exists(".mygit/")) {
+        cout << "Must initialize a mygit repository first using mygit init." << endl;
+        exit(1);
+    }
+
+    string headCommit = resolveRevision("HEAD");
+    CommitInfo head;
+    string headTree = !headCommit.empty() && readCommit(headCommit, head) ? head.tree : "";
+
+    map<string, string> staged;
+    vector<IndexEntry> entries = collectAllIndexEntries();
+    for (int i = 0; i < entries.size(); i++) {
+        staged[entries[i].path] = entries[i].hashString;
+    }
+
+    StatusCache cache;
+    bool cached = loadStatusCache(cache);
+    string newToken;
+    vector<string> changed;
+    bool monitored = fsmonitorQuery(cached ? cache.token : "", newToken, changed) && cached;
+
+    if (!monitored && !allowFullScan) {
+        return false;
+    }
+
+    IgnoreMatcher ignoreMatcher;
+    set<string> candidates;
+
+    if (monitored) {
+        candidates.insert(cache.paths.begin(), cache.paths.end());
+
+        vector<pair<string, string>> treeChanges;
+        diffTrees(cache.headTree, headTree, "", treeChanges);
+        for (int i = 0; i < treeChanges.size(); i++) {
+            candidates.insert(treeChanges[i].first);
+        }
+
+        //A reported directory may have been created, or moved away with tracked files inside it.
+        for (int i = 0; i < changed.size(); i++) {
+            collectWorkingPaths(changed[i], candidates, ignoreMatcher);
+
+            TreeEntry entry;
+            if (lookupPathEntryInTree(headTree, changed[i], entry) && entry.mode == DIRECTORY_MODE) {
+                collectTreePaths(entry.hash, changed[i] + "/", candidates);
+            }
+        }
+    } else {
+        collectTreePaths(headTree, "", candidates);
+        collectWorkingPaths("", candidates, ignoreMatcher);
+    }
+
+    for (auto it = staged.begin(); it != staged.end(); ++it) {
+        candidates.insert(it->first);
+    }
+
+    vector<string> paths(candidates.begin(), candidates.end());
+    vector<string> headHashes(paths.size());
+    vector<string> expected(paths.size());
+
+    for (int i = 0; i < paths.size(); i++) {
+        TreeEntry entry;
+        if (lookupPathEntryInTree(headTree, paths[i], entry) && entry.mode != DIRECTORY_MODE) {
+            headHashes[i] = entry.hash;
+        }
+
+        auto stagedEntry = staged.find(paths[i]);
+        expected[i] = stagedEntry != staged.end() ? stagedEntry->second : headHashes[i];
+    }
+
+    //Hash the tracked files on one thread per core. A file that cannot be read is treated as deleted.
+    vector<string> actual(paths.size());
+    vector<char> present(paths.size(), 0);
+
+    size_t threadCount = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), paths.size()));
+    atomic<size_t> next{0};
+    vector<thread> hashers;
+
+    for (size_t t = 0; t < threadCount; t++) {
+        hashers.emplace_back([&] {
+            for (size_t i = next++; i < paths.size(); i = next++) {
+                error_code ec;
+                if (!filesystem::is_regular_file(paths[i], ec)) {
+                    continue;
+                }
+
+                present[i] = 1;
+                if (expected[i].empty()) {
+                    continue;
+                }
+
+                //A file that changed while it was read gets a hash that cannot match, so it shows as modified.
+                if (!hashBlobFile(paths[i], actual[i]) && actual[i].empty()) {
+                    present[i] = 0;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < hashers.size(); i++) {
+        hashers[i].join();
+    }
+
+    for (int i = 0; i < paths.size(); i++) {
+        auto stagedEntry = staged.find(paths[i]);
+        if (stagedEntry != staged.end() && stagedEntry->second != headHashes[i]) {
+            result.staged.push_back(make_pair(headHashes[i].empty() ? "new file" : "modified", paths[i]));
+        }
+
+        if (!present[i]) {
+            if (!expected[i].empty()) {
+                result.deleted.push_back(paths[i]);
+            }
+        } else if (expected[i].empty()) {
+            if (!isPathIgnored(paths[i], ignoreMatcher)) {
+                result.untracked.push_back(paths[i]);
+            }
+        } else if (actual[i] != expected[i]) {
+            result.modified.push_back(paths[i]);
+        }
+    }
+
+    if (newToken.empty()) {
+        error_code ec;
+        filesystem::remove(STATUS_CACHE_PATH, ec);
+        return true;
+    }
+
+    //Staged paths are kept too, since the index can change without the monitor seeing it.
+    StatusCache updated{newToken, headTree, {}};
+    for (auto it = staged.begin(); it != staged.end(); ++it) {
+        updated.paths.push_back(it->first);
+    }
+    updated.paths.insert(updated.paths.end(), result.modified.begin(), result.modified.end());
+    updated.paths.insert(updated.paths.end(), result.deleted.begin(), result.deleted.end());
+    updated.paths.insert(updated.paths.end(), result.untracked.begin(), result.untracked.end());
+
+    //Tracked files can be added inside ignored directories, which the monitor does not watch, so they are
+    //examined on every scan. Changing the ignore rules starts a new session and so a full scan.
+    for (int i = 0; i < paths.size(); i++) {
+        size_t slash = paths[i].rfind('/');
+        if (!expected[i].empty() && slash != string::npos &&
+            isPathIgnored(paths[i].substr(0, slash + 1), ignoreMatcher)) {
+            updated.paths.push_back(paths[i]);
+        }
+    }
+    saveStatusCache(updated);
+
+    return true;
+}
+
+
+
+
+void status() {
+    WorkingTreeStatus result;
+    scanWorkingTree(result, true);
+
+    if (result.staged.empty() && result.modified.empty() && result.deleted.empty() && result.untracked.empty()) {
+        cout << "Nothing to commit, working tree clean." << endl;
+        return;
+    }
+
+    if (!result.staged.empty()) {
+        cout << "Changes staged for commit:" << endl;
+        for (int i = 0; i < result.staged.size(); i++) {
+            cout << "    " << result.staged[i].first << ": " << result.staged[i].second << endl;
+        }
+    }
+
+    if (!result.modified.empty() || !result.deleted.empty()) {
+        cout << "Changes not staged for commit:" << endl;
+        for (int i = 0; i < result.modified.size(); i++) {
+            cout << "    modified: " << result.modified[i] << endl;
+        }
+        for (int i = 0; i < result.deleted.size(); i++) {
+            cout << "    deleted: " << result.deleted[i] << endl;
+        }
+    }
+
+    if (!result.untracked.empty()) {
+        cout << "Untracked files:" << endl;
+        for (int i = 0; i < result.untracked.size(); i++) {
+            cout << "    " << result.untracked[i] << endl;
+        }
+    }
+}
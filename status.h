@@ -0,0 +1,53 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef STATUS_H
+#define STATUS_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#include "util.h"
+#include "commit.h"
+#include "tree.h"
+#include "ignore.h"
+#include "fsmonitor.h"
+
+using namespace std;
+
+//The fsmonitor token of the last scan, the HEAD tree it compared against, and every path that was not clean.
+const string STATUS_CACHE_PATH = FSMONITOR_DIRECTORY + "status";
+
+struct StatusCache {
+    string token;
+    string headTree;
+    vector<string> paths;
+};
+
+struct WorkingTreeStatus {
+    vector<pair<string, string>> staged;
+    vector<string> modified;
+    vector<string> deleted;
+    vector<string> untracked;
+};
+
+
+
+void collectTreePaths(const string&, const string&, set<string>&);
+void collectWorkingPaths(const string&, set<string>&, IgnoreMatcher&);
+bool isPathIgnored(const string&, IgnoreMatcher&);
+bool loadStatusCache(StatusCache&);
+void saveStatusCache(const StatusCache&);
+bool scanWorkingTree(WorkingTreeStatus&, bool);
+void status();
+
+
+#endif //STATUS_H
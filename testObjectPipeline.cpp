@@ -0,0 +1,558 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+//Generates random repositories and runs them through add, commit and log, checking every object against an
+//independent SHA-256 and recording throughput next to the results. Options:
+//  --seed N          random seed (default 1)
+//  --repos N         number of repositories to generate (default 5)
+//  --max-files N     most files per repository (default 200)
+//  --max-size BYTES  largest ordinary file (default 4 MiB)
+//  --max-depth N     deepest directory nesting (default 12)
+//  --rounds N        commits per repository (default 3)
+//  --large-size BYTES  also add one sparse file of this size per repository, e.g. 4294967296 (default off).
+//                    The test only streams it, but add holds the file and its object in memory, so this
+//                    needs about twice BYTES of free memory.
+//  --keep            keep the generated repositories
+//Exits with 1 if any check fails.
+//Build with: g++ -std=c++17 -O2 -pthread testObjectPipeline.cpp $(ls *.cpp | grep -v -e '^main.cpp' -e '^test' -e '^fuzz') -lz -lcrypto -o testObjectPipeline
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "util.h"
+#include "init.h"
+#include "add.h"
+#include "commit.h"
+#include "log.h"
+#include "tree.h"
+
+using namespace std;
+
+
+struct TestOptions {
+    unsigned long long seed = 1;
+    int repos = 5;
+    int maxFiles = 200;
+    size_t maxSize = 4 * 1024 * 1024;
+    int maxDepth = 12;
+    int rounds = 3;
+    unsigned long long largeSize = 0;
+    bool keep = false;
+};
+
+struct Throughput {
+    unsigned long long bytesAdded = 0;
+    int filesAdded = 0;
+    double addSeconds = 0;
+    double commitSeconds = 0;
+    double logSeconds = 0;
+    double verifySeconds = 0;
+};
+
+int failures = 0;
+
+
+
+
+//SHA-256 written from FIPS 180-4, sharing no code with OpenSSL, used as the reference for every object hash.
+//Input is fed in pieces, so large files and objects can be hashed without holding them in memory.
+class ReferenceSha256 {
+public:
+    void update(const char* data, size_t size) {
+        length += size;
+
+        while (size > 0) {
+            size_t take = min<size_t>(size, 64 - buffered);
+            memcpy(block + buffered, data, take);
+            buffered += take;
+            data += take;
+            size -= take;
+
+            if (buffered == 64) {
+                compress(block);
+                buffered = 0;
+            }
+        }
+    }
+
+    string digest() {
+        //Message is padded with 0x80, zeros and the 64 bit big-endian bit length to a multiple of 64 bytes.
+        uint64_t bitLength = length * 8;
+        unsigned char padding[72] = {0x80};
+        size_t padSize = (buffered < 56 ? 56 : 120) - buffered;
+        for (int i = 0; i < 8; i++) {
+            padding[padSize + 7 - i] = (bitLength >> (8 * i)) & 0xff;
+        }
+        update(reinterpret_cast<const char*>(padding), padSize + 8);
+
+        string digest;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 3; j >= 0; j--) {
+                digest.push_back((h[i] >> (8 * j)) & 0xff);
+            }
+        }
+
+        return hashBinaryToString(digest);
+    }
+
+private:
+    void compress(const unsigned char* data) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+        uint32_t w[64];
+        for (int t = 0; t < 16; t++) {
+            w[t] = (uint32_t)data[t * 4] << 24 | (uint32_t)data[t * 4 + 1] << 16 | (uint32_t)data[t * 4 + 2] << 8 | data[t * 4 + 3];
+        }
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int t = 0; t < 64; t++) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[t] + w[t];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    unsigned char block[64];
+    size_t buffered = 0;
+    uint64_t length = 0;
+};
+
+
+
+
+string referenceSha256(const string& input) {
+    ReferenceSha256 hasher;
+    hasher.update(input.data(), input.size());
+    return hasher.digest();
+}
+
+
+
+
+//Reference hash of a file as a blob object, read a piece at a time.
+string referenceBlobHash(const string& path) {
+    ReferenceSha256 hasher;
+    string header = "blob " + to_string(filesystem::file_size(path)) + '\0';
+    hasher.update(header.data(), header.size());
+
+    ifstream file(path, ios::binary);
+    vector<char> buffer(1 << 20);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        hasher.update(buffer.data(), file.gcount());
+    }
+
+    return hasher.digest();
+}
+
+
+
+
+void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+
+
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+
+
+//Runs f with stdout sent to a file (or /dev/null), so the pipeline's progress output does not flood the report.
+template <typename F>
+void withStdoutTo(const string& path, F f) {
+    cout.flush();
+    fflush(stdout);
+
+    int saved = dup(STDOUT_FILENO);
+    int target = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(target, STDOUT_FILENO);
+    close(target);
+
+    f();
+
+    cout.flush();
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+
+
+
+//Generates file contents: empty, text made of random words, or random binary bytes.
+string randomContents(mt19937_64& rng, size_t maxSize) {
+    uniform_int_distribution<int> kind(0, 9);
+    int k = kind(rng);
+
+    //Most files are small, as in real trees.
+    size_t limit = k < 7 ? min<size_t>(maxSize, 4096) : maxSize;
+    size_t size = k == 0 ? 0 : uniform_int_distribution<size_t>(1, max<size_t>(1, limit))(rng);
+
+    string contents;
+    contents.reserve(size);
+
+    if (k < 6) {
+        static const char* words[] = {"tree", "blob", "commit", "index", "merge", "the", "a", "hash", "\n", "  "};
+        while (contents.size() < size) {
+            contents += words[rng() % 10];
+            contents += ' ';
+        }
+        contents.resize(size);
+    } else {
+        while (contents.size() < size) {
+            uint64_t bits = rng();
+            contents.append(reinterpret_cast<const char*>(&bits), min<size_t>(8, size - contents.size()));
+        }
+    }
+
+    return contents;
+}
+
+
+
+
+//Picks a random path up to maxDepth directories deep.
+string randomPath(mt19937_64& rng, int maxDepth, int fileNumber) {
+    int depth = uniform_int_distribution<int>(0, maxDepth)(rng);
+    string path;
+
+    for (int i = 0; i < depth; i++) {
+        path += "d" + to_string(rng() % 3) + "/";
+    }
+
+    return path + "f" + to_string(fileNumber) + (rng() % 2 ? ".txt" : ".bin");
+}
+
+
+
+
+void writeFile(const string& path, const string& contents) {
+    filesystem::path filePath(path);
+    if (filePath.has_parent_path()) {
+        filesystem::create_directories(filePath.parent_path());
+    }
+
+    ofstream file(path, ios::binary);
+    file.write(contents.data(), contents.size());
+}
+
+
+
+
+//Creates a sparse file of the given size with a few random bytes scattered through it. Returns its reference
+//blob hash; the contents are never held in memory.
+string writeSparseFile(mt19937_64& rng, const string& path, unsigned long long size) {
+    {
+        ofstream file(path, ios::binary);
+    }
+    filesystem::resize_file(path, size);
+
+    fstream file(path, ios::binary | ios::in | ios::out);
+    for (int i = 0; i < 16; i++) {
+        uint64_t bits = rng();
+        file.seekp(rng() % (size > 8 ? size - 8 : 1));
+        file.write(reinterpret_cast<const char*>(&bits), min<unsigned long long>(8, size));
+    }
+    file.close();
+
+    return referenceBlobHash(path);
+}
+
+
+
+
+//Checks every object in the store: it must inflate, and its name must be the reference hash of its contents.
+//Objects are inflated and hashed a piece at a time, so a large blob is never held in memory.
+void verifyObjectStore() {
+    int objects = 0;
+
+    for (auto it = filesystem::recursive_directory_iterator(".mygit/objects"); it != filesystem::recursive_directory_iterator(); ++it) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+
+        string hash = it->path().parent_path().filename().string() + it->path().filename().string();
+        ifstream objectFile(it->path(), ios::binary);
+
+        z_stream stream{};
+        inflateInit(&stream);
+        ReferenceSha256 hasher;
+        vector<char> in(1 << 20);
+        vector<char> out(1 << 20);
+        unsigned long long inflated = 0;
+        int ret = Z_OK;
+
+        while (ret != Z_STREAM_END && (objectFile.read(in.data(), in.size()) || objectFile.gcount() > 0)) {
+            stream.next_in = reinterpret_cast<unsigned char*>(in.data());
+            stream.avail_in = objectFile.gcount();
+
+            do {
+                stream.next_out = reinterpret_cast<unsigned char*>(out.data());
+                stream.avail_out = out.size();
+                ret = inflate(&stream, Z_NO_FLUSH);
+
+                size_t have = out.size() - stream.avail_out;
+                hasher.update(out.data(), have);
+                inflated += have;
+            } while (ret == Z_OK && stream.avail_out == 0);
+
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                break;
+            }
+        }
+        inflateEnd(&stream);
+
+        check(ret == Z_STREAM_END && inflated > 0, "object " + hash + " inflates");
+        check(hasher.digest() == hash, "object " + hash + " matches its reference hash");
+        objects++;
+    }
+
+    check(objects > 0, "object store is not empty");
+}
+
+
+
+
+//Checks that the tree of the commit at HEAD holds exactly the expected blob for every file. Large files are
+//given by their reference hash rather than their contents.
+void verifyTree(const map<string, string>& files, const map<string, string>& largeFiles) {
+    CommitInfo head;
+    check(readCommit(resolveRevision("HEAD"), head), "HEAD commit can be read");
+
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        string expected = referenceSha256("blob " + to_string(it->second.size()) + '\0' + it->second);
+        check(lookupPathInTree(head.tree, it->first) == expected, "tree entry for " + it->first);
+    }
+
+    for (auto it = largeFiles.begin(); it != largeFiles.end(); ++it) {
+        check(lookupPathInTree(head.tree, it->first) == it->second, "tree entry for " + it->first);
+    }
+}
+
+
+
+
+//Checks that log lists exactly the commits made, newest first.
+void verifyLog(const vector<string>& commits, Throughput& throughput) {
+    string logPath = ".mygit/test-log";
+    LogOptions options;
+    options.format = "%H";
+
+    auto start = chrono::steady_clock::now();
+    withStdoutTo(logPath, [&] { commitLog(options); });
+    throughput.logSeconds += secondsSince(start);
+
+    ifstream logFile(logPath);
+    vector<string> logged;
+    string line;
+    while (getline(logFile, line)) {
+        if (line.size() == 2 * SHA256_DIGEST_LENGTH) {
+            logged.push_back(line);
+        }
+    }
+
+    check(logged == vector<string>(commits.rbegin(), commits.rend()), "log lists every commit newest first");
+}
+
+
+
+
+void runRepository(const TestOptions& options, int number, Throughput& throughput) {
+    mt19937_64 rng(options.seed * 1000003 + number);
+    filesystem::path original = filesystem::current_path();
+    filesystem::path repo = filesystem::temp_directory_path() / ("mygit-test-" + to_string(options.seed) + "-" + to_string(number));
+
+    filesystem::remove_all(repo);
+    filesystem::create_directories(repo);
+    filesystem::current_path(repo);
+
+    withStdoutTo("/dev/null", [] { init(); });
+    ofstream config(".mygit/config");
+    config << "[user]\nname = test\nemail = test@example.com\n";
+    config.close();
+
+    map<string, string> files;
+    vector<string> commits;
+    int fileNumber = 0;
+
+    int fileCount = uniform_int_distribution<int>(1, max(1, options.maxFiles))(rng);
+    for (int i = 0; i < fileCount; i++) {
+        string path = randomPath(rng, options.maxDepth, fileNumber++);
+        files[path] = randomContents(rng, options.maxSize);
+        writeFile(path, files[path]);
+    }
+
+    map<string, string> largeFiles;
+    if (options.largeSize > 0) {
+        largeFiles["large.bin"] = writeSparseFile(rng, "large.bin", options.largeSize);
+    }
+
+    for (int round = 0; round < options.rounds; round++) {
+        vector<string> changed;
+
+        if (round == 0) {
+            for (auto it = files.begin(); it != files.end(); ++it) {
+                changed.push_back(it->first);
+            }
+            if (!largeFiles.empty()) {
+                throughput.bytesAdded += options.largeSize;
+                throughput.filesAdded++;
+            }
+        } else {
+            //Modify some files and create a few new ones.
+            for (auto it = files.begin(); it != files.end(); ++it) {
+                if (rng() % 4 == 0) {
+                    it->second = randomContents(rng, options.maxSize);
+                    writeFile(it->first, it->second);
+                    changed.push_back(it->first);
+                }
+            }
+            for (int i = 0; i < 3; i++) {
+                string path = randomPath(rng, options.maxDepth, fileNumber++);
+                files[path] = randomContents(rng, options.maxSize);
+                writeFile(path, files[path]);
+                changed.push_back(path);
+            }
+        }
+
+        for (int i = 0; i < changed.size(); i++) {
+            throughput.bytesAdded += files[changed[i]].size();
+        }
+        throughput.filesAdded += changed.size();
+
+        auto start = chrono::steady_clock::now();
+        withStdoutTo("/dev/null", [&] { add(round == 0 ? vector<string>{"."} : changed); });
+        throughput.addSeconds += secondsSince(start);
+
+        string message = "round " + to_string(round);
+        start = chrono::steady_clock::now();
+        withStdoutTo("/dev/null", [&] { commit(message); });
+        throughput.commitSeconds += secondsSince(start);
+
+        commits.push_back(resolveRevision("HEAD"));
+
+        start = chrono::steady_clock::now();
+        verifyTree(files, largeFiles);
+        verifyObjectStore();
+        throughput.verifySeconds += secondsSince(start);
+
+        verifyLog(commits, throughput);
+    }
+
+    filesystem::current_path(original);
+    if (!options.keep) {
+        filesystem::remove_all(repo);
+    }
+
+    cout << "repository " << number << ": " << files.size() + largeFiles.size() << " files, " << commits.size() << " commits" << endl;
+}
+
+
+
+
+int main(int argc, char* argv[]) {
+    TestOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (arg == "--seed") {
+            options.seed = stoull(value);
+            i++;
+        } else if (arg == "--repos") {
+            options.repos = stoi(value);
+            i++;
+        } else if (arg == "--max-files") {
+            options.maxFiles = stoi(value);
+            i++;
+        } else if (arg == "--max-size") {
+            options.maxSize = stoull(value);
+            i++;
+        } else if (arg == "--max-depth") {
+            options.maxDepth = stoi(value);
+            i++;
+        } else if (arg == "--rounds") {
+            options.rounds = stoi(value);
+            i++;
+        } else if (arg == "--large-size") {
+            options.largeSize = stoull(value);
+            i++;
+        } else if (arg == "--keep") {
+            options.keep = true;
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    //The reference hash must agree with the published test vectors before it can be trusted.
+    check(referenceSha256("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", "reference SHA-256 of empty input");
+    check(referenceSha256("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "reference SHA-256 of abc");
+    check(referenceSha256(string(1000, 'a')) == sha256(string(1000, 'a')), "reference SHA-256 agrees with sha256()");
+
+    Throughput throughput;
+    for (int i = 0; i < options.repos; i++) {
+        runRepository(options, i, throughput);
+    }
+
+    double mib = throughput.bytesAdded / (1024.0 * 1024.0);
+    cout << "add:    " << throughput.filesAdded << " files, " << mib << " MiB in " << throughput.addSeconds << " s ("
+         << (throughput.addSeconds > 0 ? mib / throughput.addSeconds : 0) << " MiB/s)" << endl;
+    cout << "commit: " << throughput.commitSeconds << " s" << endl;
+    cout << "log:    " << throughput.logSeconds << " s" << endl;
+    cout << "verify: " << throughput.verifySeconds << " s" << endl;
+
+    if (failures > 0) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,419 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#include "tree.h"
+
+
+//Opens the journal at path. Entries are only kept if the journal was written for the same index checksum
+//and base tree; otherwise a fresh journal is started.
+TreeJournal::TreeJournal(const string& path, const string& indexChecksum, const string& baseTree) : path(path) {
+    string header = "index " + indexChecksum + " base " + (baseTree.empty() ? "none" : baseTree);
+
+    ifstream journalFile(path);
+    string line;
+
+    if (journalFile.is_open() && getline(journalFile, line) && line == header) {
+        while (getline(journalFile, line)) {
+            //Lines are "<tree hash> <directory>", the root directory being empty.
+            if (line.size() > 2 * SHA256_DIGEST_LENGTH) {
+                completed[line.substr(2 * SHA256_DIGEST_LENGTH + 1)] = line.substr(0, 2 * SHA256_DIGEST_LENGTH);
+            }
+        }
+        resumed = completed.size();
+        journalFile.close();
+        return;
+    }
+
+    journalFile.close();
+
+    ofstream newJournal(path, ios::trunc);
+    newJournal << header << "\n";
+    newJournal.close();
+}
+
+
+
+
+//Finds a tree written by an earlier, interrupted run.
+bool TreeJournal::lookup(const string& directory, string& hash) const {
+    auto found = completed.find(directory);
+    if (found == completed.end()) {
+        return false;
+    }
+
+    hash = found->second;
+    return true;
+}
+
+
+
+
+//Notes that the tree for directory has been queued on the writer. The note reaches the journal once the
+//batch it is in has been flushed.
+void TreeJournal::record(const string& directory, const string& hash, ObjectWriter& writer) {
+    pending.push_back(hash + " " + directory);
+    written++;
+
+    if (progress != nullptr) {
+        progress->update(resumed + written);
+    }
+
+    if (pending.size() >= JOURNAL_BATCH_SIZE) {
+        sync(writer);
+    }
+}
+
+
+
+
+//Flushes the writer, then appends every pending tree to the journal.
+void TreeJournal::sync(ObjectWriter& writer) {
+    if (pending.empty()) {
+        return;
+    }
+
+    writer.flush();
+
+    string lines;
+    for (int i = 0; i < pending.size(); i++) {
+        lines += pending[i] + "\n";
+    }
+
+    ofstream journalFile(path, ios::app);
+    journalFile << lines;
+    journalFile.close();
+
+    pending.clear();
+}
+
+
+
+
+//Deletes the journal once the commit is complete.
+void TreeJournal::remove() {
+    error_code ec;
+    filesystem::remove(path, ec);
+}
+
+
+
+
+size_t TreeJournal::resumedCount() const {
+    return resumed;
+}
+
+
+
+
+void TreeJournal::setProgress(Progress* progress) {
+    this->progress = progress;
+}
+
+
+
+
+
+//Parses the content of a tree object. Each entry is "<mode> <name>\0" followed by the binary hash.
+vector<TreeEntry> parseTree(const string& content) {
+    vector<TreeEntry> entries;
+    size_t pos = 0;
+
+    while (pos < content.size()) {
+        size_t space = content.find(' ', pos);
+        size_t nul = content.find('\0', pos);
+
+        if (space == string::npos || nul == string::npos || space > nul ||
+            nul + 1 + SHA256_DIGEST_LENGTH > content.size()) {
+            cout << "Malformed tree object" << endl;
+            break;
+        }
+
+        TreeEntry entry;
+        entry.mode = content.substr(pos, space - pos);
+        entry.name = content.substr(space + 1, nul - space - 1);
+        entry.hash = hashBinaryToString(content.substr(nul + 1, SHA256_DIGEST_LENGTH));
+        entries.push_back(entry);
+
+        pos = nul + 1 + SHA256_DIGEST_LENGTH;
+    }
+
+    return entries;
+}
+
+
+
+
+//Reads a tree object by hash. Trees are cached since walks over history read the same trees repeatedly.
+vector<TreeEntry> readTree(const string& hash) {
+    static unordered_map<string, vector<TreeEntry>> treeCache;
+
+    auto cached = treeCache.find(hash);
+    if (cached != treeCache.end()) {
+        return cached->second;
+    }
+
+    string type;
+    string content;
+    vector<TreeEntry> entries;
+
+    if (readObject(hash, type, content) && type == "tree") {
+        entries = parseTree(content);
+    }
+
+    treeCache[hash] = entries;
+    return entries;
+}
+
+
+
+
+//Finds the entry of a tree that path falls under. Returns its index and sets remainder to the part of
+//path below that entry, or returns -1. Older trees store the full path as a single entry name, so an exact
+//match is checked first.
+int findPathEntryIndex(const vector<TreeEntry>& entries, const string& path, string& remainder) {
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].name == path) {
+            remainder = "";
+            return i;
+        }
+    }
+
+    for (int i = 0; i < entries.size(); i++) {
+        const string& name = entries[i].name;
+
+        if (entries[i].mode == DIRECTORY_MODE && path.size() > name.size() &&
+            path.compare(0, name.size(), name) == 0 && path[name.size()] == '/') {
+            remainder = path.substr(name.size() + 1);
+            return i;
+        }
+    }
+
+    remainder = "";
+    return -1;
+}
+
+
+
+
+//Like findPathEntryIndex, but returns the hash of the entry, or an empty string.
+string findPathEntry(const vector<TreeEntry>& entries, const string& path, string& remainder) {
+    int index = findPathEntryIndex(entries, path, remainder);
+    return index < 0 ? "" : entries[index].hash;
+}
+
+
+
+
+//Returns the hash of the blob or subtree at path inside the tree, or an empty string if the path is absent.
+string lookupPathInTree(const string& treeHash, const string& path) {
+    if (path.empty() || treeHash.empty()) {
+        return treeHash;
+    }
+
+    string remainder;
+    string entryHash = findPathEntry(readTree(treeHash), path, remainder);
+
+    return lookupPathInTree(entryHash, remainder);
+}
+
+
+
+
+//Like lookupPathInTree, but returns the whole entry, so callers can tell blobs from subtrees.
+bool lookupPathEntryInTree(const string& treeHash, const string& path, TreeEntry& entry) {
+    if (path.empty() || treeHash.empty()) {
+        return false;
+    }
+
+    vector<TreeEntry> entries = readTree(treeHash);
+    string remainder;
+    int index = findPathEntryIndex(entries, path, remainder);
+
+    if (index < 0) {
+        return false;
+    }
+
+    if (remainder.empty()) {
+        entry = entries[index];
+        return true;
+    }
+
+    return lookupPathEntryInTree(entries[index].hash, remainder, entry);
+}
+
+
+
+
+//Checks whether path differs between two trees. Walks both trees one directory at a time and stops
+//as soon as the subtrees along the path have the same hash, so unchanged subtrees are never read.
+bool pathChangedBetweenTrees(const string& treeA, const string& treeB, const string& path) {
+    if (treeA == treeB) {
+        return false;
+    }
+
+    if (treeA.empty() || treeB.empty() || path.empty()) {
+        return true;
+    }
+
+    string remainderA;
+    string remainderB;
+    string entryA = findPathEntry(readTree(treeA), path, remainderA);
+    string entryB = findPathEntry(readTree(treeB), path, remainderB);
+
+    //Both trees split the path the same way, so keep comparing one level down.
+    if (remainderA == remainderB) {
+        return pathChangedBetweenTrees(entryA, entryB, remainderA);
+    }
+
+    return lookupPathInTree(entryA, remainderA) != lookupPathInTree(entryB, remainderB);
+}
+
+
+
+
+//Serializes tree entries (kept sorted by name) into the content of a tree object.
+string serializeTree(const map<string, TreeEntry>& entries) {
+    string tree;
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        vector<unsigned char> hashBinary = hashStringToBinary(it->second.hash);
+
+        tree += it->second.mode + " " + it->second.name + '\0';
+        tree.append(hashBinary.begin(), hashBinary.end());
+    }
+
+    return tree;
+}
+
+
+
+
+//Writes a new tree that is baseTree with the blobs in changes (path -> blob hash) put in place, creating
+//subtrees for directories as needed. Only the trees along changed paths are read and rewritten; every other
+//subtree keeps its hash. Full-path entries from older single-level trees are moved into subtrees.
+//Subtrees are written before the tree holding them, and each one is recorded in the journal if there is one.
+string writeTreeWithChanges(const string& baseTree, const map<string, string>& changes, ObjectWriter& writer,
+                            TreeJournal* journal, const string& directory) {
+    string journaledHash;
+    if (journal != nullptr && journal->lookup(directory, journaledHash)) {
+        return journaledHash;
+    }
+
+    map<string, TreeEntry> entries;
+    map<string, map<string, string>> subtreeChanges;
+
+    vector<TreeEntry> baseEntries = baseTree.empty() ? vector<TreeEntry>() : readTree(baseTree);
+    for (int i = 0; i < baseEntries.size(); i++) {
+        size_t slash = baseEntries[i].name.find('/');
+
+        if (slash == string::npos) {
+            entries[baseEntries[i].name] = baseEntries[i];
+        } else if (changes.find(baseEntries[i].name) == changes.end()) {
+            subtreeChanges[baseEntries[i].name.substr(0, slash)][baseEntries[i].name.substr(slash + 1)] = baseEntries[i].hash;
+        }
+    }
+
+    for (auto it = changes.begin(); it != changes.end(); ++it) {
+        size_t slash = it->first.find('/');
+
+        if (slash == string::npos) {
+            entries[it->first] = TreeEntry{NORMAL_FILE_MODE, it->first, it->second};
+        } else {
+            subtreeChanges[it->first.substr(0, slash)][it->first.substr(slash + 1)] = it->second;
+        }
+    }
+
+    for (auto it = subtreeChanges.begin(); it != subtreeChanges.end(); ++it) {
+        auto existing = entries.find(it->first);
+        string subtreeBase = existing != entries.end() && existing->second.mode == DIRECTORY_MODE ? existing->second.hash : "";
+
+        string subtreeDirectory = directory.empty() ? it->first : directory + "/" + it->first;
+        string subtreeHash = writeTreeWithChanges(subtreeBase, it->second, writer, journal, subtreeDirectory);
+        entries[it->first] = TreeEntry{DIRECTORY_MODE, it->first, subtreeHash};
+    }
+
+    string hashedTree = writeObject(writer, "tree", serializeTree(entries));
+
+    if (journal != nullptr) {
+        journal->record(directory, hashedTree, writer);
+    }
+
+    return hashedTree;
+}
+
+
+
+
+//Counts the trees writeTreeWithChanges will write for a set of changed paths: the root and every directory
+//holding a changed path.
+size_t countTreesToWrite(const map<string, string>& changes) {
+    set<string> directories;
+
+    for (auto it = changes.begin(); it != changes.end(); ++it) {
+        size_t slash = it->first.find('/');
+        while (slash != string::npos) {
+            directories.insert(it->first.substr(0, slash));
+            slash = it->first.find('/', slash + 1);
+        }
+    }
+
+    return directories.size() + 1;
+}
+
+
+
+
+//Collects the blob paths that differ between two trees as (path, new blob hash) pairs. A removed path has an
+//empty hash. Subtrees with the same hash on both sides are skipped without being read.
+void diffTrees(const string& oldTree, const string& newTree, const string& prefix, vector<pair<string, string>>& changes) {
+    if (oldTree == newTree) {
+        return;
+    }
+
+    map<string, TreeEntry> oldEntries;
+    map<string, TreeEntry> newEntries;
+
+    vector<TreeEntry> entries = oldTree.empty() ? vector<TreeEntry>() : readTree(oldTree);
+    for (int i = 0; i < entries.size(); i++) {
+        oldEntries[entries[i].name] = entries[i];
+    }
+
+    entries = newTree.empty() ? vector<TreeEntry>() : readTree(newTree);
+    for (int i = 0; i < entries.size(); i++) {
+        newEntries[entries[i].name] = entries[i];
+    }
+
+    for (auto it = oldEntries.begin(); it != oldEntries.end(); ++it) {
+        if (newEntries.find(it->first) == newEntries.end()) {
+            newEntries[it->first] = TreeEntry{it->second.mode, it->first, ""};
+        }
+    }
+
+    for (auto it = newEntries.begin(); it != newEntries.end(); ++it) {
+        auto old = oldEntries.find(it->first);
+        TreeEntry oldEntry = old != oldEntries.end() ? old->second : TreeEntry{it->second.mode, it->first, ""};
+        string path = prefix + it->first;
+
+        if (oldEntry.hash == it->second.hash && oldEntry.mode == it->second.mode) {
+            continue;
+        }
+
+        bool oldIsTree = oldEntry.mode == DIRECTORY_MODE && !oldEntry.hash.empty();
+        bool newIsTree = it->second.mode == DIRECTORY_MODE && !it->second.hash.empty();
+
+        if (oldIsTree || newIsTree) {
+            //A file replaced by a directory (or the reverse) removes one side and adds the other.
+            if (!oldIsTree && !oldEntry.hash.empty()) {
+                changes.push_back(make_pair(path, ""));
+            }
+            if (!newIsTree && !it->second.hash.empty()) {
+                changes.push_back(make_pair(path, it->second.hash));
+            }
+
+            diffTrees(oldIsTree ? oldEntry.hash : "", newIsTree ? it->second.hash : "", path + "/", changes);
+        } else {
+            changes.push_back(make_pair(path, it->second.hash));
+        }
+    }
+}
@@ -0,0 +1,75 @@
+//
+// Created by dylan on 10/19/2026.
+//
+
+#ifndef TREE_H
+#define TREE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+
+#include "util.h"
+#include "objectWriter.h"
+#include "progress.h"
+
+using namespace std;
+
+const string NORMAL_FILE_MODE = "100644";
+const string DIRECTORY_MODE = "40000";
+
+//Trees recorded in the journal are made durable in batches of this many.
+constexpr size_t JOURNAL_BATCH_SIZE = 512;
+
+struct TreeEntry {
+    string mode;
+    string name;
+    string hash;
+};
+
+
+
+//Records which trees of a commit in progress are already on disk, so an interrupted commit can resume
+//without rewriting them. The journal belongs to one index and one base tree; any other commit starts over.
+//A tree is only appended to the journal after the ObjectWriter has flushed it.
+class TreeJournal {
+public:
+    TreeJournal(const string&, const string&, const string&);
+
+    bool lookup(const string&, string&) const;
+    void record(const string&, const string&, ObjectWriter&);
+    void sync(ObjectWriter&);
+    void remove();
+    size_t resumedCount() const;
+    void setProgress(Progress*);
+
+private:
+    string path;
+    map<string, string> completed;
+    vector<string> pending;
+    size_t resumed = 0;
+    size_t written = 0;
+    Progress* progress = nullptr;
+};
+
+
+
+vector<TreeEntry> parseTree(const string&);
+vector<TreeEntry> readTree(const string&);
+int findPathEntryIndex(const vector<TreeEntry>&, const string&, string&);
+string findPathEntry(const vector<TreeEntry>&, const string&, string&);
+string lookupPathInTree(const string&, const string&);
+bool lookupPathEntryInTree(const string&, const string&, TreeEntry&);
+bool pathChangedBetweenTrees(const string&, const string&, const string&);
+string serializeTree(const map<string, TreeEntry>&);
+string writeTreeWithChanges(const string&, const map<string, string>&, ObjectWriter&,
+                            TreeJournal* = nullptr, const string& = "");
+size_t countTreesToWrite(const map<string, string>&);
+void diffTrees(const string&, const string&, const string&, vector<pair<string, string>>&);
+
+
+#endif //TREE_H
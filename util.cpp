@@ -19,11 +19,25 @@ string readFile(const string& filePath) {
         exit(1);
     }
 
-    stringstream buffer;
-    buffer << file.rdbuf();
+    //Pipes and other input that cannot seek have no size to read up to, so they are streamed instead.
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    if (size < 0) {
+        file.clear();
+        ostringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    //Read straight into the result, so a large file is only held in memory once. A file that shrank while
+    //being read is cut to what was actually read.
+    string contents(size, '\0');
+    file.seekg(0);
+    file.read(&contents[0], size);
+    contents.resize(file.gcount());
     file.close();
 
-    return buffer.str();
+    return contents;
 }
 
 
@@ -65,8 +79,26 @@ vector<unsigned char> hashStringToBinary(string s) {
 
 
 
+//Converts a binary hash back to its hex string representation.
+string hashBinaryToString(const string& binary) {
+    static const char hexDigits[] = "0123456789abcdef";
+    string hash;
+    hash.reserve(binary.size() * 2);
+
+    for (int i = 0; i < binary.size(); i++) {
+        unsigned char byte = binary[i];
+        hash.push_back(hexDigits[byte >> 4]);
+        hash.push_back(hexDigits[byte & 0x0f]);
+    }
+
+    return hash;
+}
+
+
+
+
 //Hashes an input string using the sha256 technique.
-string sha256(string s) {
+string sha256(const string& s) {
     unsigned char hash[SHA256_DIGEST_LENGTH];
 
     //Parameters to OpenSSL SHA256 are pointers to character strings.
@@ -86,8 +118,51 @@ string sha256(string s) {
 
 
 
+
+//Hashes a file as a blob object without holding it in memory. Returns false if the file cannot be read,
+//or if its size changed while it was read.
+bool hashBlobFile(const string& path, string& hash) {
+    error_code ec;
+    uintmax_t size = filesystem::file_size(path, ec);
+    ifstream file(path, ios::binary);
+    if (ec || !file) {
+        return false;
+    }
+
+    EVP_MD_CTX* context = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(context, EVP_sha256(), nullptr);
+
+    string header = "blob " + to_string(size) + '\0';
+    EVP_DigestUpdate(context, header.data(), header.size());
+
+    vector<char> buffer(CHUNK_SIZE * 16);
+    uintmax_t total = 0;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        EVP_DigestUpdate(context, buffer.data(), file.gcount());
+        total += file.gcount();
+    }
+
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    EVP_DigestFinal_ex(context, digest, nullptr);
+    EVP_MD_CTX_free(context);
+
+    hash = hashBinaryToString(string(reinterpret_cast<char*>(digest), SHA256_DIGEST_LENGTH));
+    return total == size;
+}
+
+
+
 //Compresses a vector of chars using the DEFLATE algorithm from zlib.
-vector<unsigned char> compressUsingDeflate(vector<unsigned char> original) {
+vector<unsigned char> compressUsingDeflate(const vector<unsigned char>& original) {
+    return compressUsingDeflate(original.data(), original.size());
+}
+
+
+
+
+//Compresses size bytes at data using the DEFLATE algorithm from zlib. zlib counts input in 32 bits, so
+//anything larger than ZLIB_MAX_INPUT is handed to deflate in pieces.
+vector<unsigned char> compressUsingDeflate(const unsigned char* data, size_t size) {
     vector<unsigned char> result;
 
     z_stream defstream{};
@@ -104,29 +179,34 @@ vector<unsigned char> compressUsingDeflate(vector<unsigned char> original) {
         return {};
     }
 
-    //Size of bytes in vector
-    defstream.avail_in =  original.size();
+    size_t offset = 0;
+    int flush;
 
-    //Pointer to first location in memory of vector
-    defstream.next_in = original.data();
+    do {
+        size_t piece = min<size_t>(size - offset, ZLIB_MAX_INPUT);
+        defstream.next_in = const_cast<unsigned char*>(data + offset);
+        defstream.avail_in = piece;
+        offset += piece;
+        flush = offset == size ? Z_FINISH : Z_NO_FLUSH;
 
+        do {
+            defstream.next_out = out;
+            defstream.avail_out = CHUNK_SIZE;
 
-    do {
-        defstream.next_out = out;
-        defstream.avail_out = CHUNK_SIZE;
+            ret = deflate(&defstream, flush);
 
-        ret = deflate(&defstream, Z_FINISH);
+            if (ret != Z_STREAM_END && ret != Z_OK && ret != Z_BUF_ERROR) {
+                cout << "deflate failed with code: " << ret << endl;
+                deflateEnd(&defstream);
+                return {};
+            }
 
-        if (ret != Z_STREAM_END && ret != Z_OK && ret != Z_BUF_ERROR) {
-            cout << "deflate failed with code: " << ret << endl;
-            deflateEnd(&defstream);
-            return {};
-        }
+            have = CHUNK_SIZE - defstream.avail_out;
+            result.insert(result.end(), out, out + have);
 
-        have = CHUNK_SIZE - defstream.avail_out;
-        result.insert(result.end(), out, out + have);
+        } while (defstream.avail_out == 0);
 
-    } while (defstream.avail_out == 0);
+    } while (flush != Z_FINISH);
 
     // clean up and return
     (void)deflateEnd(&defstream);
@@ -137,11 +217,11 @@ vector<unsigned char> compressUsingDeflate(vector<unsigned char> original) {
 
 
 
-//Decompresses a file using zlib and its inflate algorithm
-vector<unsigned char> decompressUsingInflate(vector<unsigned char> original) {
+//Decompresses a file using zlib and its inflate algorithm. Like deflate, input is handed over in pieces.
+vector<unsigned char> decompressUsingInflate(const vector<unsigned char>& original) {
     vector<unsigned char> result;
 
-    int ret;
+    int ret = Z_OK;
     z_stream defstream{};
     size_t have;
 
@@ -158,26 +238,33 @@ vector<unsigned char> decompressUsingInflate(vector<unsigned char> original) {
         return {};
     }
 
-    defstream.avail_in = original.size();
-    defstream.next_in = original.data();
+    size_t offset = 0;
 
     do {
-        defstream.next_out = out;
-        defstream.avail_out = CHUNK_SIZE;
+        size_t piece = min<size_t>(original.size() - offset, ZLIB_MAX_INPUT);
+        defstream.next_in = const_cast<unsigned char*>(original.data() + offset);
+        defstream.avail_in = piece;
+        offset += piece;
 
-        ret = inflate(&defstream, Z_NO_FLUSH);
+        do {
+            defstream.next_out = out;
+            defstream.avail_out = CHUNK_SIZE;
 
-        if (ret != Z_STREAM_END && ret != Z_OK && ret != Z_BUF_ERROR) {
-            cout << "inflate failed: " << ret << endl;
-            inflateEnd(&defstream);
-            return {};
-        }
+            ret = inflate(&defstream, Z_NO_FLUSH);
+
+            if (ret != Z_STREAM_END && ret != Z_OK && ret != Z_BUF_ERROR) {
+                cout << "inflate failed: " << ret << endl;
+                inflateEnd(&defstream);
+                return {};
+            }
 
 
-        have = CHUNK_SIZE - defstream.avail_out;
-        result.insert(result.end(), out, out + have);
+            have = CHUNK_SIZE - defstream.avail_out;
+            result.insert(result.end(), out, out + have);
 
-    } while (defstream.avail_out == 0);
+        } while (defstream.avail_out == 0);
+
+    } while (ret != Z_STREAM_END && offset < original.size());
 
     (void)inflateEnd(&defstream);
 
@@ -202,6 +289,52 @@ void writeBinaryToFile(const string& filename, vector<unsigned char>& data) {
 
 
 
+//Returns the path of an object in the object store, split into a folder for the first two
+//characters of the hash and a file for the rest (as used in git).
+string objectPath(const string& hash) {
+    return ".mygit/objects/" + hash.substr(0, 2) + "/" + hash.substr(2, hash.length());
+}
+
+
+
+
+//Reads and decompresses an object from the object store, splitting it into its type and content.
+//Returns false if the object does not exist or is malformed.
+bool readObject(const string& hash, string& type, string& content) {
+    if (hash.size() < 3) {
+        return false;
+    }
+
+    ifstream objectFile(objectPath(hash), ios::binary);
+    if (!objectFile.is_open()) {
+        return false;
+    }
+
+    vector<unsigned char> data{istreambuf_iterator<char>(objectFile), istreambuf_iterator<char>()};
+    objectFile.close();
+
+    vector<unsigned char> decompressedData = decompressUsingInflate(data);
+
+    //Header is "<type> <size>\0"
+    auto headerEnd = find(decompressedData.begin(), decompressedData.end(), '\0');
+    if (headerEnd == decompressedData.end()) {
+        return false;
+    }
+
+    string header(decompressedData.begin(), headerEnd);
+    size_t space = header.find(' ');
+    if (space == string::npos) {
+        return false;
+    }
+
+    type = header.substr(0, space);
+    content.assign(headerEnd + 1, decompressedData.end());
+    return true;
+}
+
+
+
+
 
 pair<string, string> parseConfigFileForUser() {
     ifstream configFile(".mygit/config");
@@ -250,19 +383,124 @@ string parseHeadForBranch(ifstream& headFile) {
 
 
 
+//Reads the commit hash a ref file points to. Returns an empty string if the ref has no commit yet.
+string readRef(const string& refPath) {
+    ifstream refFile(refPath);
+    string hash;
+
+    if (refFile.is_open()) {
+        getline(refFile, hash);
+        refFile.close();
+    }
+
+    return hash;
+}
+
+
+
+
+//Points a ref file at a commit. The new value is written to a temporary file and renamed over the ref,
+//so the ref holds either the old or the new hash even if the process dies. Returns false on failure.
+bool updateRef(const string& refPath, const string& hash) {
+    string tempPath = refPath + ".lock";
+
+    ofstream refFile(tempPath, ios::trunc);
+    if (!refFile.is_open()) {
+        return false;
+    }
+
+    refFile << hash;
+    refFile.close();
+
+    error_code ec;
+    if (!refFile || (filesystem::rename(tempPath, refPath, ec), ec)) {
+        filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+//Resolves HEAD, a branch name or a full commit hash to a commit hash. Returns an empty string if it names nothing.
+string resolveRevision(const string& name) {
+    if (name == "HEAD") {
+        ifstream headFile(".mygit/HEAD");
+        return readRef(".mygit/" + parseHeadForBranch(headFile));
+    }
+
+    if (name.find("..") == string::npos && filesystem::is_regular_file(".mygit/refs/heads/" + name)) {
+        return readRef(".mygit/refs/heads/" + name);
+    }
+
+    if (name.size() == 2 * SHA256_DIGEST_LENGTH && filesystem::exists(objectPath(name))) {
+        return name;
+    }
+
+    return "";
+}
+
+
+
+
+//Returns the commits listed in the shallow file. History below them is treated as absent: their parents are
+//never followed. Read once per process.
+unordered_set<string>& shallowCommits() {
+    static unordered_set<string> commits;
+    static bool loaded = false;
+
+    if (!loaded) {
+        ifstream shallowFile(SHALLOW_PATH);
+        string line;
+
+        while (getline(shallowFile, line)) {
+            if (!line.empty()) {
+                commits.insert(line);
+            }
+        }
+
+        loaded = true;
+    }
+
+    return commits;
+}
+
+
+
+
+//Parses index entries, one "<hash> <path>" per line, from a stream.
+vector<IndexEntry> parseIndexEntries(istream& stream) {
+    vector<IndexEntry> entries;
+    string line;
+
+    while (getline(stream, line)) {
+        istringstream iss(line);
+        IndexEntry entry;
+        iss >> entry.hashString >> entry.path;
+
+        //Blank or truncated lines are not entries.
+        if (entry.hashString.empty() || entry.path.empty()) {
+            continue;
+        }
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+
+
+
 //Collects all index entries from the index file and stores them in a vector of <IndexEntry>
 vector<IndexEntry> collectAllIndexEntries() {
     vector<IndexEntry> entries;
     ifstream indexFile(".mygit/index");
-    string line;
 
     if (indexFile.is_open()) {
-        while (getline(indexFile, line)) {
-            istringstream iss(line);
-            IndexEntry entry;
-            iss >> entry.hashString >> entry.path;
-            entries.push_back(entry);
-        }
+        entries = parseIndexEntries(indexFile);
     } else {
         cout << "Error opening index file" << endl;
     }
@@ -270,4 +508,3 @@ vector<IndexEntry> collectAllIndexEntries() {
     indexFile.close();
     return entries;
 }
-
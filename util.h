@@ -10,8 +10,13 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
 #include <zlib.h>
 #include <openssl/sha.h>
+#include <openssl/evp.h>
 
 using namespace std;
 
@@ -23,17 +28,32 @@ struct IndexEntry {
 
 constexpr int CHUNK_SIZE = 16384;
 
+//Largest input handed to zlib in one call, whose byte counts are 32 bits wide.
+constexpr size_t ZLIB_MAX_INPUT = 1 << 30;
+
+const string SHALLOW_PATH = ".mygit/shallow";
+
 
 
 string readFile(const string&);
 unsigned char hexCharToNum(char);
 vector<unsigned char> hashStringToBinary(string);
-string sha256(string);
-vector<unsigned char> compressUsingDeflate(vector<unsigned char>);
-vector<unsigned char> decompressUsingInflate(vector<unsigned char>);
+string hashBinaryToString(const string&);
+string sha256(const string&);
+bool hashBlobFile(const string&, string&);
+vector<unsigned char> compressUsingDeflate(const vector<unsigned char>&);
+vector<unsigned char> compressUsingDeflate(const unsigned char*, size_t);
+vector<unsigned char> decompressUsingInflate(const vector<unsigned char>&);
 void writeBinaryToFile(const string&, vector<unsigned char>&);
+string objectPath(const string&);
+bool readObject(const string&, string&, string&);
 pair<string, string> parseConfigFileForUser();
 string parseHeadForBranch(ifstream&);
+string readRef(const string&);
+bool updateRef(const string&, const string&);
+string resolveRevision(const string&);
+unordered_set<string>& shallowCommits();
+vector<IndexEntry> parseIndexEntries(istream&);
 vector<IndexEntry> collectAllIndexEntries();
 
 